@@ -0,0 +1,137 @@
+#include "mqmx/message_dispatcher.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+/*
+ * Cost of dispatching of a message to the handler of its type.
+ *
+ * 'switch' row is the reference of a single handler per queue, which
+ * switches on message ID and casts the message by itself (called through
+ * std::function as message_queue_pool does). Messages of eight types are
+ * created and dispatched in round-robin, so the cost of creation of the
+ * message is included into each row.
+ *
+ * Usage: message_dispatch [number-of-messages (default 10000000)]
+ */
+namespace
+{
+    using bench_clock = std::chrono::steady_clock;
+    using mqmx::message;
+    using mqmx::status_code;
+
+    const size_t NTYPES = 8;
+    const mqmx::queue_id_type BENCH_QUEUE_ID = 0;
+
+    template <size_t N>
+    struct typed_message : message
+    {
+        size_t value;
+
+        typed_message (const size_t v)
+            : message (BENCH_QUEUE_ID, N)
+            , value (v)
+        { }
+    };
+
+    /* sink of handled values, so handlers are not optimized out */
+    volatile size_t sink = 0;
+
+    template <size_t N>
+    status_code handle (typed_message<N> & msg)
+    {
+        sink = sink + msg.value + N;
+        return mqmx::ExitStatus::Success;
+    }
+
+    message::upointer_type make (const size_t ix)
+    {
+        switch (ix % NTYPES)
+        {
+        case 0: return message::upointer_type (new typed_message<0> (ix));
+        case 1: return message::upointer_type (new typed_message<1> (ix));
+        case 2: return message::upointer_type (new typed_message<2> (ix));
+        case 3: return message::upointer_type (new typed_message<3> (ix));
+        case 4: return message::upointer_type (new typed_message<4> (ix));
+        case 5: return message::upointer_type (new typed_message<5> (ix));
+        case 6: return message::upointer_type (new typed_message<6> (ix));
+        default: return message::upointer_type (new typed_message<7> (ix));
+        }
+    }
+
+    status_code switch_handler (message::upointer_type && msg)
+    {
+        switch (msg->get_mid ())
+        {
+        case 0: return handle (static_cast<typed_message<0> &> (*msg));
+        case 1: return handle (static_cast<typed_message<1> &> (*msg));
+        case 2: return handle (static_cast<typed_message<2> &> (*msg));
+        case 3: return handle (static_cast<typed_message<3> &> (*msg));
+        case 4: return handle (static_cast<typed_message<4> &> (*msg));
+        case 5: return handle (static_cast<typed_message<5> &> (*msg));
+        case 6: return handle (static_cast<typed_message<6> &> (*msg));
+        case 7: return handle (static_cast<typed_message<7> &> (*msg));
+        default: return mqmx::ExitStatus::NotFound;
+        }
+    }
+
+    struct visitor
+    {
+        template <size_t N>
+        status_code operator () (typed_message<N> & msg)
+        {
+            return handle (msg);
+        }
+    };
+
+    template <size_t N>
+    using binding = mqmx::message_binding<N, typed_message<N>>;
+
+    typedef mqmx::static_message_dispatcher<
+        visitor, binding<0>, binding<1>, binding<2>, binding<3>,
+        binding<4>, binding<5>, binding<6>, binding<7>> static_dispatcher_type;
+
+    template <typename dispatch_type>
+    double run (const size_t nmessages, dispatch_type && dispatch)
+    {
+        const auto start = bench_clock::now ();
+        for (size_t ix = 0; ix < nmessages; ++ix)
+            dispatch (make (ix));
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds> (
+            bench_clock::now () - start);
+        return static_cast<double> (elapsed.count ()) / nmessages;
+    }
+} /* namespace */
+
+int main (int argc, char ** argv)
+{
+    const size_t nmessages = (argc > 1) ? std::strtoul (argv[1], nullptr, 10) : 10000000;
+
+    const std::function<status_code(message::upointer_type &&)> handler (&switch_handler);
+
+    mqmx::message_dispatcher dispatcher;
+    dispatcher.set_handler<typed_message<0>> (0, &handle<0>);
+    dispatcher.set_handler<typed_message<1>> (1, &handle<1>);
+    dispatcher.set_handler<typed_message<2>> (2, &handle<2>);
+    dispatcher.set_handler<typed_message<3>> (3, &handle<3>);
+    dispatcher.set_handler<typed_message<4>> (4, &handle<4>);
+    dispatcher.set_handler<typed_message<5>> (5, &handle<5>);
+    dispatcher.set_handler<typed_message<6>> (6, &handle<6>);
+    dispatcher.set_handler<typed_message<7>> (7, &handle<7>);
+
+    static_dispatcher_type static_dispatcher;
+
+    std::printf ("%-8s %10s\n", "dispatch", "ns/msg");
+    std::printf ("%-8s %10.1f\n", "switch",
+                 run (nmessages, [&](message::upointer_type && msg) {
+                         return handler (std::move (msg)); }));
+    std::printf ("%-8s %10.1f\n", "table",
+                 run (nmessages, [&](message::upointer_type && msg) {
+                         return dispatcher.dispatch (std::move (msg)); }));
+    std::printf ("%-8s %10.1f\n", "static",
+                 run (nmessages, [&](message::upointer_type && msg) {
+                         return static_dispatcher.dispatch (std::move (msg)); }));
+    return 0;
+}
@@ -0,0 +1,485 @@
+#include "mqmx/message_queue.h"
+#include "mqmx/message_queue_poll.h"
+#include "mqmx/message_queue_pool.h"
+#include "mqmx/mpsc_message_queue.h"
+#include "mqmx/spsc_message_queue.h"
+#include "mqmx/work_queue.h"
+#include <crs/semaphore.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Benchmark suite of mqmx primitives.
+ *
+ * Each scenario prints a single line with JSON object (JSON lines format),
+ * so results could be collected and compared by scripts:
+ *
+ *   {"bench":"message_queue","backend":"mpsc","producers":4,"consumers":1,
+ *    "payload":64,"ops":400000,"ops_per_sec":...,"p50_ns":...,"p99_ns":...,
+ *    "p999_ns":...}
+ *
+ * Throughput is the number of operations (messages, polls, works) per second
+ * of wall clock time, latency percentiles are measured per operation:
+ *  - message_queue  - push to pop of the message (producers x consumers x
+ *                     payload size); throughput is measured with producers
+ *                     flooding the queue, latency is measured separately
+ *                     under bounded load (each producer keeps a single
+ *                     message in flight), so it's the cost of operations
+ *                     rather than the age of backlog
+ *  - poll           - single poll() call over N queues, one of them has data
+ *  - pool           - push to handler call in message_queue_pool
+ *  - work_queue_*   - schedule_work/cancel_work calls with N pending timers,
+ *                     firing lateness of N timers spread over 100ms
+ *
+ * Usage: mqmx_suite [--quick] [bench-name-filter]
+ */
+namespace
+{
+    using bench_clock = std::chrono::steady_clock;
+    using mqmx::work_queue;
+
+    const mqmx::message_id_type BENCH_MESSAGE_ID = 1;
+
+    bool quick = false;
+
+    uint64_t now_ns ()
+    {
+        return static_cast<uint64_t> (std::chrono::duration_cast<std::chrono::nanoseconds> (
+            bench_clock::now ().time_since_epoch ()).count ());
+    }
+
+    struct result_type
+    {
+        size_t                ops;
+        double                seconds;
+        std::vector<uint64_t> samples; /* latency of operations in ns */
+
+        result_type ()
+            : ops (0)
+            , seconds (0)
+            , samples ()
+        { }
+    };
+
+    uint64_t percentile (const std::vector<uint64_t> & sorted, const double p)
+    {
+        if (sorted.empty ())
+            return 0;
+        return sorted[static_cast<size_t> (p / 100.0 * (sorted.size () - 1))];
+    }
+
+    /* params is a list of JSON members, e.g. "\"backend\":\"mpsc\",\"producers\":4" */
+    void report (const char * bench, const std::string & params, result_type & r)
+    {
+        std::sort (r.samples.begin (), r.samples.end ());
+        std::printf ("{\"bench\":\"%s\",%s,\"ops\":%zu,\"ops_per_sec\":%.0f,"
+                     "\"p50_ns\":%llu,\"p99_ns\":%llu,\"p999_ns\":%llu}\n",
+                     bench, params.c_str (), r.ops,
+                     (r.seconds > 0) ? r.ops / r.seconds : 0.0,
+                     static_cast<unsigned long long> (percentile (r.samples, 50)),
+                     static_cast<unsigned long long> (percentile (r.samples, 99)),
+                     static_cast<unsigned long long> (percentile (r.samples, 99.9)));
+        std::fflush (stdout);
+    }
+
+    std::string param (const char * name, const size_t value)
+    {
+        return std::string ("\"") + name + "\":" + std::to_string (value);
+    }
+
+    std::string param (const char * name, const char * value)
+    {
+        return std::string ("\"") + name + "\":\"" + value + "\"";
+    }
+
+    /*
+     * Message with timestamp of creation and payload of N bytes.
+     */
+    template <size_t N>
+    struct timed_message : mqmx::message
+    {
+        uint64_t timestamp;
+        char     payload[N];
+
+        timed_message (const mqmx::queue_id_type qid)
+            : mqmx::message (qid, BENCH_MESSAGE_ID)
+            , timestamp (now_ns ())
+        {
+            std::memset (payload, 0, sizeof (payload));
+        }
+    };
+
+    template <size_t N>
+    uint64_t latency_of (const mqmx::message & msg)
+    {
+        return now_ns () - static_cast<const timed_message<N> &> (msg).timestamp;
+    }
+
+    /* push, which is retried while bounded queue is full */
+    template <size_t N>
+    void push_message (mqmx::message_queue & mq)
+    {
+        while (mq.enqueue<timed_message<N>> () != mqmx::ExitStatus::Success)
+            std::this_thread::yield ();
+    }
+
+    /*
+     * Passes messages from producers to consumers, returns elapsed time in
+     * seconds. If max_in_flight is not zero, producers wait while this number
+     * of messages is pushed but not popped yet. Latency of each message is
+     * added to samples (if given).
+     */
+    template <size_t N>
+    double run_load (mqmx::message_queue & mq, const size_t nproducers,
+                     const size_t nconsumers, const size_t nmessages,
+                     const size_t max_in_flight, std::vector<uint64_t> * samples)
+    {
+        const size_t total = nproducers * nmessages;
+        std::atomic<size_t> in_flight (0);
+        std::atomic<size_t> popped (0);
+        std::vector<std::vector<uint64_t>> consumer_samples (nconsumers);
+
+        const auto start = bench_clock::now ();
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < nproducers; ++i)
+        {
+            threads.emplace_back ([&mq, &in_flight, nmessages, max_in_flight]{
+                    for (size_t n = 0; n < nmessages; ++n)
+                    {
+                        while (max_in_flight && (max_in_flight <= in_flight.fetch_add (1)))
+                        {
+                            --in_flight;
+                            std::this_thread::yield ();
+                        }
+                        push_message<N> (mq);
+                    }
+                });
+        }
+
+        for (size_t i = 0; i < nconsumers; ++i)
+        {
+            std::vector<uint64_t> * csamples = samples ? &consumer_samples[i] : nullptr;
+            threads.emplace_back ([&mq, &in_flight, &popped, csamples, total, max_in_flight]{
+                    while (popped.load () < total)
+                    {
+                        mqmx::message::upointer_type msg = mq.pop ();
+                        if (!msg)
+                        {
+                            std::this_thread::yield ();
+                            continue;
+                        }
+                        if (csamples)
+                            csamples->push_back (latency_of<N> (*msg));
+                        if (max_in_flight)
+                            --in_flight;
+                        ++popped;
+                    }
+                });
+        }
+
+        for (auto & thread : threads)
+            thread.join ();
+        const double seconds = std::chrono::duration<double> (bench_clock::now () - start).count ();
+
+        if (samples)
+        {
+            for (const auto & csamples : consumer_samples)
+                samples->insert (samples->end (), csamples.begin (), csamples.end ());
+        }
+        return seconds;
+    }
+
+    template <size_t N>
+    result_type run_message_queue (mqmx::message_queue & mq, const size_t nproducers,
+                                   const size_t nconsumers)
+    {
+        const size_t nmessages = (quick ? 10000 : 200000) / nproducers;
+        const size_t nsamples = (quick ? 2000 : 20000) / nproducers;
+
+        result_type r;
+        r.ops = nproducers * nmessages;
+        r.seconds = run_load<N> (mq, nproducers, nconsumers, nmessages, 0, nullptr);
+
+        r.samples.reserve (nproducers * nsamples);
+        run_load<N> (mq, nproducers, nconsumers, nsamples, nproducers, &r.samples);
+        return r;
+    }
+
+    template <size_t N>
+    void bench_message_queue ()
+    {
+        for (const size_t nproducers : {1, 2, 4})
+        {
+            const std::string params = param ("producers", nproducers) + ",";
+            const std::string payload = "," + param ("payload", N);
+            for (const size_t nconsumers : {1, 2})
+            {
+                /* the only backend, which allows multiple consumers */
+                mqmx::message_queue mq (0);
+                result_type r = run_message_queue<N> (mq, nproducers, nconsumers);
+                report ("message_queue", param ("backend", "mutex") + "," + params +
+                        param ("consumers", nconsumers) + payload, r);
+            }
+
+            const std::string single = params + param ("consumers", 1) + payload;
+            {
+                mqmx::mpsc_message_queue mq (0);
+                result_type r = run_message_queue<N> (mq, nproducers, 1);
+                report ("message_queue", param ("backend", "mpsc") + "," + single, r);
+            }
+            {
+                /* overhead of statistics */
+                mqmx::mpsc_message_queue mq (0);
+                mqmx::queue_stats stats;
+                mq.set_stats (&stats);
+                result_type r = run_message_queue<N> (mq, nproducers, 1);
+                report ("message_queue", param ("backend", "mpsc+stats") + "," + single, r);
+            }
+            if (nproducers == 1)
+            {
+                mqmx::spsc_message_queue mq (0);
+                result_type r = run_message_queue<N> (mq, nproducers, 1);
+                report ("message_queue", param ("backend", "spsc") + "," + single, r);
+            }
+        }
+    }
+
+    void bench_poll ()
+    {
+        const size_t npolls = quick ? 2000 : 20000;
+        for (const size_t nqueues : {1, 16, 256})
+        {
+            std::vector<std::unique_ptr<mqmx::message_queue>> queues;
+            std::vector<mqmx::message_queue *> mqs;
+            for (size_t i = 0; i < nqueues; ++i)
+            {
+                queues.emplace_back (new mqmx::message_queue (i));
+                mqs.push_back (queues.back ().get ());
+            }
+
+            std::mt19937 rng (nqueues);
+            result_type r;
+            r.ops = npolls;
+            r.samples.reserve (npolls);
+
+            double total = 0;
+            for (size_t i = 0; i < npolls; ++i)
+            {
+                mqmx::message_queue * mq = mqs[rng () % nqueues];
+                mq->enqueue<timed_message<8>> ();
+
+                const auto start = bench_clock::now ();
+                const auto mqlist = mqmx::poll (mqs.begin (), mqs.end ());
+                const auto elapsed = bench_clock::now () - start;
+
+                r.samples.push_back (static_cast<uint64_t> (
+                        std::chrono::duration_cast<std::chrono::nanoseconds> (elapsed).count ()));
+                total += std::chrono::duration<double> (elapsed).count ();
+                if (mqlist.size () != 1)
+                    std::fprintf (stderr, "poll: unexpected number of notifications\n");
+                mq->pop ();
+            }
+            r.seconds = total;
+            report ("poll", param ("queues", nqueues), r);
+        }
+    }
+
+    void bench_pool ()
+    {
+        const size_t nmessages = quick ? 10000 : 200000;
+        for (const size_t nworkers : {1, 4})
+        {
+            for (const size_t nqueues : {1, 16})
+            {
+                mqmx::message_queue_pool pool (nqueues, nworkers);
+                crs::semaphore done;
+                std::atomic<size_t> handled (0);
+
+                /* each queue is handled by single worker at a time */
+                std::vector<std::vector<uint64_t>> samples (nqueues);
+                std::vector<mqmx::message_queue_pool::mq_upointer_type> queues;
+                for (size_t i = 0; i < nqueues; ++i)
+                {
+                    std::vector<uint64_t> & qsamples = samples[i];
+                    qsamples.reserve (nmessages / nqueues + 1);
+                    queues.push_back (pool.allocate_queue (
+                            [&qsamples, &handled, &done, nmessages](
+                                mqmx::message::upointer_type && msg) {
+                                qsamples.push_back (latency_of<8> (*msg));
+                                if (++handled == nmessages)
+                                    done.post ();
+                                return mqmx::ExitStatus::Success;
+                            }));
+                }
+
+                /* one producer per queue (up to 4), queues are fed in turn */
+                const size_t nproducers = std::min<size_t> (nqueues, 4);
+                const auto start = bench_clock::now ();
+                std::vector<std::thread> producers;
+                for (size_t p = 0; p < nproducers; ++p)
+                {
+                    producers.emplace_back ([&, p]{
+                            for (size_t i = p; i < nmessages; i += nproducers)
+                                push_message<8> (*queues[i % nqueues]);
+                        });
+                }
+                for (auto & producer : producers)
+                    producer.join ();
+                done.wait ();
+
+                result_type r;
+                r.ops = nmessages;
+                r.seconds = std::chrono::duration<double> (bench_clock::now () - start).count ();
+                for (const auto & qsamples : samples)
+                    r.samples.insert (r.samples.end (), qsamples.begin (), qsamples.end ());
+                report ("pool", param ("workers", nworkers) + "," + param ("queues", nqueues), r);
+            }
+        }
+    }
+
+    const char * engine_name (const work_queue::timer_engine engine)
+    {
+        return (engine == work_queue::timer_wheel) ? "wheel" : "heap";
+    }
+
+    void bench_work_queue_ops (const work_queue::timer_engine engine, const size_t ntimers)
+    {
+        const size_t nops = std::min<size_t> (ntimers, quick ? 1000 : 10000);
+        std::mt19937_64 rng (ntimers);
+        work_queue wq (engine);
+
+        const work_queue::client_id_type client_id = wq.get_client_id ();
+        const work_queue::time_point_type now = wq.get_current_time_point ();
+        auto work = [](const work_queue::work_id_type) { return false; };
+        auto far_offset = [&rng]{
+            return std::chrono::hours (1) + std::chrono::microseconds (rng () % 3600000000ULL);
+        };
+
+        std::vector<work_queue::work_id_type> ids;
+        ids.reserve (ntimers + nops);
+        for (size_t i = 0; i < ntimers; ++i)
+            ids.push_back (wq.schedule_work (client_id, work, now + far_offset ()).second);
+
+        const std::string params = param ("engine", engine_name (engine)) + "," +
+            param ("timers", ntimers);
+
+        result_type r;
+        r.ops = nops;
+        for (size_t i = 0; i < nops; ++i)
+        {
+            const auto tp = now + far_offset ();
+            const auto start = bench_clock::now ();
+            ids.push_back (wq.schedule_work (client_id, work, tp).second);
+            const auto elapsed = bench_clock::now () - start;
+            r.samples.push_back (static_cast<uint64_t> (
+                    std::chrono::duration_cast<std::chrono::nanoseconds> (elapsed).count ()));
+            r.seconds += std::chrono::duration<double> (elapsed).count ();
+        }
+        report ("work_queue_schedule", params, r);
+
+        std::shuffle (ids.begin (), ids.end (), rng);
+        r = result_type ();
+        r.ops = nops;
+        for (size_t i = 0; i < nops; ++i)
+        {
+            const auto start = bench_clock::now ();
+            wq.cancel_work (ids[i]);
+            const auto elapsed = bench_clock::now () - start;
+            r.samples.push_back (static_cast<uint64_t> (
+                    std::chrono::duration_cast<std::chrono::nanoseconds> (elapsed).count ()));
+            r.seconds += std::chrono::duration<double> (elapsed).count ();
+        }
+        report ("work_queue_cancel", params, r);
+    }
+
+    void bench_work_queue_fire (const work_queue::timer_engine engine, const size_t ntimers)
+    {
+        work_queue wq (engine);
+        crs::semaphore done;
+        std::atomic<size_t> fired (0);
+        std::vector<uint64_t> lateness (ntimers);
+
+        const work_queue::client_id_type client_id = wq.get_client_id ();
+        const auto window = std::chrono::milliseconds (100);
+        const work_queue::time_point_type start = wq.get_current_time_point () +
+            std::chrono::milliseconds (10);
+
+        for (size_t i = 0; i < ntimers; ++i)
+        {
+            const work_queue::time_point_type tp = start + (window * i) / ntimers;
+            wq.schedule_work (
+                client_id,
+                [&, i, tp, ntimers](const work_queue::work_id_type) {
+                    lateness[i] = static_cast<uint64_t> (
+                        std::chrono::duration_cast<std::chrono::nanoseconds> (
+                            bench_clock::now () - tp).count ());
+                    if (++fired == ntimers)
+                        done.post ();
+                    return false;
+                },
+                tp);
+        }
+        done.wait ();
+
+        result_type r;
+        r.ops = ntimers;
+        r.seconds = std::chrono::duration<double> (bench_clock::now () - start).count ();
+        r.samples.swap (lateness);
+        report ("work_queue_fire",
+                param ("engine", engine_name (engine)) + "," + param ("timers", ntimers), r);
+    }
+
+    void bench_work_queue ()
+    {
+        for (const auto engine : {work_queue::binary_heap, work_queue::timer_wheel})
+        {
+            for (const size_t ntimers : {1000, 10000, 100000})
+            {
+                if (quick && (ntimers > 10000))
+                    continue;
+                bench_work_queue_ops (engine, ntimers);
+                bench_work_queue_fire (engine, ntimers);
+            }
+        }
+    }
+
+    bool selected (const char * filter, const char * name)
+    {
+        return !filter || std::strstr (name, filter);
+    }
+} /* namespace */
+
+int main (int argc, char ** argv)
+{
+    const char * filter = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (0 == std::strcmp (argv[i], "--quick"))
+            quick = true;
+        else
+            filter = argv[i];
+    }
+
+    if (selected (filter, "message_queue"))
+    {
+        bench_message_queue<8> ();
+        bench_message_queue<64> ();
+        bench_message_queue<1024> ();
+    }
+    if (selected (filter, "poll"))
+        bench_poll ();
+    if (selected (filter, "pool"))
+        bench_pool ();
+    if (selected (filter, "work_queue"))
+        bench_work_queue ();
+    return 0;
+}
@@ -0,0 +1,152 @@
+#include "mqmx/work_queue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+/*
+ * Cost of update_work and cancel_work depending on the number of pending works.
+ *
+ * For each engine N far-future works are scheduled and then a fixed sample
+ * of randomly chosen works is updated and cancelled. 'linear' row is the
+ * reference of the previous implementation (linear search followed by full
+ * rebuild of the heap) performed on the plain vector of the same size.
+ *
+ * Usage: work_queue_cancel [max-number-of-works (default 1000000)]
+ */
+namespace
+{
+    using mqmx::work_queue;
+    using bench_clock = std::chrono::steady_clock;
+
+    const size_t SAMPLE_SIZE = 1000;
+    const size_t LINEAR_SAMPLE_SIZE = 100; /* each operation is O(n) */
+
+    struct result_type
+    {
+        double update_ns;
+        double cancel_ns;
+    };
+
+    double ns_per_op (const bench_clock::time_point & start, const size_t nops)
+    {
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds> (
+            bench_clock::now () - start);
+        return static_cast<double> (elapsed.count ()) / nops;
+    }
+
+    work_queue::duration_type random_offset (std::mt19937_64 & rng)
+    {
+        return std::chrono::hours (1) + std::chrono::microseconds (rng () % 3600000000ULL);
+    }
+
+    result_type run_work_queue (const work_queue::timer_engine engine, const size_t nworks)
+    {
+        std::mt19937_64 rng (nworks);
+        work_queue wq (engine);
+
+        const work_queue::client_id_type client_id = wq.get_client_id ();
+        const work_queue::time_point_type now = wq.get_current_time_point ();
+        auto work = [](const work_queue::work_id_type) { return false; };
+
+        std::vector<work_queue::work_id_type> ids;
+        ids.reserve (nworks);
+        for (size_t i = 0; i < nworks; ++i)
+            ids.push_back (wq.schedule_work (client_id, work, now + random_offset (rng)).second);
+        std::shuffle (ids.begin (), ids.end (), rng);
+
+        const size_t nops = std::min (nworks, SAMPLE_SIZE);
+        result_type result;
+
+        auto start = bench_clock::now ();
+        for (size_t i = 0; i < nops; ++i)
+            wq.update_work (ids[i], client_id, work, now + random_offset (rng), work_queue::RUN_ONCE);
+        result.update_ns = ns_per_op (start, nops);
+
+        start = bench_clock::now ();
+        for (size_t i = 0; i < nops; ++i)
+            wq.cancel_work (ids[i]);
+        result.cancel_ns = ns_per_op (start, nops);
+        return result;
+    }
+
+    result_type run_linear (const size_t nworks)
+    {
+        typedef std::pair<work_queue::time_point_type, work_queue::work_id_type> record_type;
+        auto compare = [](const record_type & a, const record_type & b) {
+            return b.first < a.first;
+        };
+
+        std::mt19937_64 rng (nworks);
+        const work_queue::time_point_type now = work_queue::clock_type::now ();
+
+        std::vector<record_type> records;
+        std::vector<work_queue::work_id_type> ids;
+        records.reserve (nworks);
+        ids.reserve (nworks);
+        for (size_t i = 0; i < nworks; ++i)
+        {
+            records.emplace_back (now + random_offset (rng), i);
+            ids.push_back (i);
+        }
+        std::make_heap (records.begin (), records.end (), compare);
+        std::shuffle (ids.begin (), ids.end (), rng);
+
+        const size_t nops = std::min (nworks, LINEAR_SAMPLE_SIZE);
+        result_type result;
+
+        auto start = bench_clock::now ();
+        for (size_t i = 0; i < nops; ++i)
+        {
+            for (auto & r : records)
+            {
+                if (r.second == ids[i])
+                {
+                    r.first = now + random_offset (rng);
+                    std::make_heap (records.begin (), records.end (), compare);
+                    break;
+                }
+            }
+        }
+        result.update_ns = ns_per_op (start, nops);
+
+        start = bench_clock::now ();
+        for (size_t i = 0; i < nops; ++i)
+        {
+            for (auto & r : records)
+            {
+                if (r.second == ids[i])
+                {
+                    std::swap (r, records.back ());
+                    records.pop_back ();
+                    std::make_heap (records.begin (), records.end (), compare);
+                    break;
+                }
+            }
+        }
+        result.cancel_ns = ns_per_op (start, nops);
+        return result;
+    }
+
+    void print (const char * name, const size_t nworks, const result_type & r)
+    {
+        std::printf ("%-8s %10zu %14.1f %14.1f\n", name, nworks, r.update_ns, r.cancel_ns);
+    }
+} /* namespace */
+
+int main (int argc, char ** argv)
+{
+    const size_t max_works = (argc > 1) ? std::strtoul (argv[1], nullptr, 10) : 1000000;
+
+    std::printf ("%-8s %10s %14s %14s\n", "engine", "works", "update ns/op", "cancel ns/op");
+    for (size_t nworks = 1000; nworks <= max_works; nworks *= 10)
+    {
+        print ("linear", nworks, run_linear (nworks));
+        print ("heap", nworks, run_work_queue (work_queue::binary_heap, nworks));
+        print ("wheel", nworks, run_work_queue (work_queue::timer_wheel, nworks));
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include "mqmx/work_queue.h"
+#include "mqmx/timerfd_work_queue.h"
+#include <crs/semaphore.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+/*
+ * Firing lateness of timers (time of execution - time point of work).
+ *
+ * Works are scheduled one by one at random offsets from 100us to 1ms,
+ * so the worker always sleeps before execution. Percentiles of lateness
+ * are reported for the original waiting on conditional variable and for
+ * timerfd waiting (with and without spinning).
+ *
+ * Usage: work_queue_lateness [number-of-works (default 2000)]
+ */
+namespace
+{
+    using mqmx::work_queue;
+    using bench_clock = work_queue::clock_type;
+
+    std::vector<double> run (work_queue & wq, const size_t nworks)
+    {
+        std::mt19937_64 rng (nworks);
+        crs::semaphore executed;
+        std::vector<double> lateness;
+        lateness.reserve (nworks);
+
+        const work_queue::client_id_type client_id = wq.get_client_id ();
+        for (size_t i = 0; i < nworks; ++i)
+        {
+            const work_queue::time_point_type tp =
+                bench_clock::now () + std::chrono::microseconds (100 + rng () % 900);
+            wq.schedule_work (
+                client_id,
+                [&executed, &lateness, tp](const work_queue::work_id_type) {
+                    const auto late = std::chrono::duration_cast<std::chrono::nanoseconds> (
+                        bench_clock::now () - tp);
+                    lateness.push_back (late.count () / 1000.0);
+                    executed.post ();
+                    return false;
+                },
+                tp);
+            executed.wait ();
+        }
+        std::sort (lateness.begin (), lateness.end ());
+        return lateness;
+    }
+
+    double percentile (const std::vector<double> & sorted, const double p)
+    {
+        const size_t index = static_cast<size_t> (p / 100.0 * (sorted.size () - 1));
+        return sorted[index];
+    }
+
+    void print (const char * name, const std::vector<double> & sorted)
+    {
+        std::printf ("%-14s %10.1f %10.1f %10.1f %10.1f %10.1f\n", name,
+                     percentile (sorted, 50), percentile (sorted, 90),
+                     percentile (sorted, 99), percentile (sorted, 99.9),
+                     sorted.back ());
+    }
+} /* namespace */
+
+int main (int argc, char ** argv)
+{
+    const size_t nworks = (argc > 1) ? std::strtoul (argv[1], nullptr, 10) : 2000;
+
+    std::printf ("%-14s %10s %10s %10s %10s %10s\n",
+                 "backend", "p50 us", "p90 us", "p99 us", "p99.9 us", "max us");
+    {
+        work_queue wq;
+        print ("condvar", run (wq, nworks));
+    }
+#if defined(__linux__)
+    {
+        mqmx::timerfd_work_queue wq;
+        print ("timerfd", run (wq, nworks));
+    }
+    {
+        mqmx::timerfd_work_queue wq (std::chrono::microseconds (50));
+        print ("timerfd+spin", run (wq, nworks));
+    }
+#endif
+    return 0;
+}
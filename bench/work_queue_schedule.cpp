@@ -0,0 +1,63 @@
+#include "mqmx/work_queue.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+/*
+ * Throughput of scheduling of immediate works from several threads.
+ *
+ * Each producer schedules the same number of works, which are executed
+ * by the worker. Time is measured until all works are executed.
+ *
+ * Usage: work_queue_schedule [works-per-thread (default 100000)]
+ */
+namespace
+{
+    using mqmx::work_queue;
+    using bench_clock = std::chrono::steady_clock;
+
+    double run (const size_t nthreads, const size_t nworks)
+    {
+        work_queue wq;
+        std::atomic<size_t> executed (0);
+        auto work = [&executed](const work_queue::work_id_type) {
+            executed.fetch_add (1, std::memory_order_relaxed);
+            return false;
+        };
+
+        const auto start = bench_clock::now ();
+        std::vector<std::thread> producers;
+        for (size_t t = 0; t < nthreads; ++t)
+        {
+            producers.emplace_back ([&]{
+                    const work_queue::client_id_type client_id = wq.get_client_id ();
+                    for (size_t i = 0; i < nworks; ++i)
+                        wq.schedule_work (client_id, work);
+                });
+        }
+        for (auto & producer : producers)
+            producer.join ();
+        const auto scheduled = bench_clock::now ();
+
+        while (executed.load (std::memory_order_relaxed) < nthreads * nworks)
+            std::this_thread::yield ();
+
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds> (
+            scheduled - start);
+        return static_cast<double> (elapsed.count ()) / (nthreads * nworks);
+    }
+} /* namespace */
+
+int main (int argc, char ** argv)
+{
+    const size_t nworks = (argc > 1) ? std::strtoul (argv[1], nullptr, 10) : 100000;
+
+    std::printf ("%-8s %14s\n", "threads", "schedule ns/op");
+    for (size_t nthreads = 1; nthreads <= 16; nthreads *= 2)
+        std::printf ("%-8zu %14.1f\n", nthreads, run (nthreads, nworks));
+    return 0;
+}
@@ -0,0 +1,365 @@
+#include <mqmx/bounded_message_queue.h>
+
+namespace mqmx
+{
+    bounded_message_queue::bounded_message_queue (const queue_id_type ID,
+                                                  const size_t max_messages,
+                                                  const overflow_policy policy,
+                                                  const size_t max_bytes,
+                                                  const message_size_func_type & size_of)
+        : message_queue (ID)
+        , _max_messages (max_messages)
+        , _max_bytes (max_bytes)
+        , _policy (policy)
+        , _size_of (size_of)
+        , _queue ()
+        , _high_watermark (0)
+        , _low_watermark (0)
+        , _above_watermark (false)
+        , _waiters (0)
+        , _space ()
+        , _size (0)
+        , _bytes (0)
+        , _dropped (0)
+        , _rejected (0)
+    {
+    }
+
+    bounded_message_queue::~bounded_message_queue ()
+    {
+    }
+
+    size_t bounded_message_queue::size_of (const message & msg) const
+    {
+        return _size_of ? _size_of (msg) : 0;
+    }
+
+    bool bounded_message_queue::fits (const size_t count, const size_t bytes) const
+    {
+        if (_max_messages && (_max_messages < _queue.size () + count))
+        {
+            return false;
+        }
+
+        /* single message is always accepted by the empty queue */
+        if (_max_bytes && (_max_bytes < _bytes.load (std::memory_order_relaxed) + bytes))
+        {
+            return _queue.empty () && (count == 1);
+        }
+        return true;
+    }
+
+    void bounded_message_queue::append (message::upointer_type && msg, const size_t bytes)
+    {
+        if (_stats)
+        {
+            _stats->pushed (*msg);
+        }
+        _queue.push_back (std::move (msg));
+        _size.store (_queue.size (), std::memory_order_relaxed);
+        _bytes.fetch_add (bytes, std::memory_order_relaxed);
+    }
+
+    message::upointer_type bounded_message_queue::remove_front ()
+    {
+        message::upointer_type msg = std::move (_queue.front ());
+        _queue.pop_front ();
+        _size.store (_queue.size (), std::memory_order_relaxed);
+        _bytes.fetch_sub (size_of (*msg), std::memory_order_relaxed);
+        if (_stats)
+        {
+            _stats->popped (*msg);
+        }
+        return msg;
+    }
+
+    void bounded_message_queue::shed (const size_t count, const size_t bytes)
+    {
+        while (!_queue.empty () && !fits (count, bytes))
+        {
+            remove_front ();
+            _dropped.fetch_add (1, std::memory_order_relaxed);
+        }
+    }
+
+    void bounded_message_queue::notify_pushed (const bool was_empty)
+    {
+        notification_flags_type flags = was_empty ? notification_flag::data : 0;
+        if (_high_watermark && !_above_watermark && (_high_watermark <= _queue.size ()))
+        {
+            _above_watermark = true;
+            flags |= notification_flag::high_watermark;
+        }
+
+        if (_listener && flags)
+        {
+            /* data is reported for the first message only */
+            _listener->notify (_id, this, flags);
+        }
+    }
+
+    void bounded_message_queue::notify_popped ()
+    {
+        if (_above_watermark && (_queue.size () <= _low_watermark))
+        {
+            _above_watermark = false;
+            if (_listener)
+            {
+                _listener->notify (_id, this, notification_flag::low_watermark);
+            }
+        }
+
+        if (_waiters)
+        {
+            _space.notify_all ();
+        }
+    }
+
+    status_code bounded_message_queue::push (message::upointer_type && msg)
+    {
+        return try_push (std::move (msg));
+    }
+
+    status_code bounded_message_queue::push (message::upointer_type && msg,
+                                             const wait_time_provider & wtp)
+    {
+        if (msg.get () == nullptr)
+        {
+            return ExitStatus::InvalidArgument;
+        }
+
+        lock_type guard (_mutex);
+        if ((_id == message::undefined_qid) ||
+            (_id != msg->get_qid ()))
+        {
+            return ExitStatus::NotSupported;
+        }
+
+        const size_t bytes = size_of (*msg);
+        const auto pred = [&]{ return fits (1, bytes); };
+        if (!pred ())
+        {
+            ++_waiters;
+            if (wtp.wait_infinitely ())
+            {
+                _space.wait (guard, pred);
+            }
+            else
+            {
+                const auto abs_time = wtp.get_time_point ();
+                if (!is_time_point_empty (abs_time))
+                {
+                    _space.wait_until (guard, abs_time, pred);
+                }
+            }
+            --_waiters;
+
+            if (!pred () && (_policy == reject))
+            {
+                _rejected.fetch_add (1, std::memory_order_relaxed);
+                return ExitStatus::Timeout;
+            }
+        }
+        return push_locked (std::move (msg));
+    }
+
+    status_code bounded_message_queue::try_push (message::upointer_type && msg)
+    {
+        if (msg.get () == nullptr)
+        {
+            return ExitStatus::InvalidArgument;
+        }
+
+        lock_type guard (_mutex);
+        if ((_id == message::undefined_qid) ||
+            (_id != msg->get_qid ()))
+        {
+            return ExitStatus::NotSupported;
+        }
+        return push_locked (std::move (msg));
+    }
+
+    status_code bounded_message_queue::push_locked (message::upointer_type && msg)
+    {
+        const size_t bytes = size_of (*msg);
+        if (!fits (1, bytes))
+        {
+            if (_policy == reject)
+            {
+                _rejected.fetch_add (1, std::memory_order_relaxed);
+                return ExitStatus::Overflow;
+            }
+
+            if (_policy == drop_newest)
+            {
+                _dropped.fetch_add (1, std::memory_order_relaxed);
+                msg.reset ();
+                return ExitStatus::Success;
+            }
+
+            shed (1, bytes);
+        }
+
+        const bool was_empty = _queue.empty ();
+        append (std::move (msg), bytes);
+        notify_pushed (was_empty);
+        return ExitStatus::Success;
+    }
+
+    message::upointer_type bounded_message_queue::pop ()
+    {
+        message::upointer_type msg;
+        lock_type guard (_mutex);
+        if (!_queue.empty ())
+        {
+            msg = remove_front ();
+            notify_popped ();
+        }
+        return msg;
+    }
+
+    status_code bounded_message_queue::push_batch (container_type & batch)
+    {
+        for (const auto & msg : batch)
+        {
+            if (msg.get () == nullptr)
+            {
+                return ExitStatus::InvalidArgument;
+            }
+        }
+
+        lock_type guard (_mutex);
+        if (_id == message::undefined_qid)
+        {
+            return ExitStatus::NotSupported;
+        }
+
+        size_t bytes = 0;
+        for (const auto & msg : batch)
+        {
+            if (_id != msg->get_qid ())
+            {
+                return ExitStatus::NotSupported;
+            }
+            bytes += size_of (*msg);
+        }
+
+        if (batch.empty ())
+        {
+            return ExitStatus::Success;
+        }
+
+        if ((_policy == reject) && !fits (batch.size (), bytes))
+        {
+            _rejected.fetch_add (batch.size (), std::memory_order_relaxed);
+            return ExitStatus::Overflow;
+        }
+
+        const bool was_empty = _queue.empty ();
+        for (auto & msg : batch)
+        {
+            const size_t msg_bytes = size_of (*msg);
+            if (!fits (1, msg_bytes))
+            {
+                if (_policy == drop_newest)
+                {
+                    _dropped.fetch_add (1, std::memory_order_relaxed);
+                    msg.reset ();
+                    continue;
+                }
+                shed (1, msg_bytes);
+            }
+            append (std::move (msg), msg_bytes);
+        }
+        batch.clear ();
+
+        notify_pushed (was_empty && !_queue.empty ());
+        return ExitStatus::Success;
+    }
+
+    size_t bounded_message_queue::drain (container_type & out, const size_t max)
+    {
+        lock_type guard (_mutex);
+        size_t count = 0;
+        for (; (count < max) && !_queue.empty (); ++count)
+        {
+            out.push_back (remove_front ());
+        }
+
+        if (count)
+        {
+            notify_popped ();
+        }
+        return count;
+    }
+
+    size_t bounded_message_queue::get_drain_limit () const
+    {
+        return 1;
+    }
+
+    status_code bounded_message_queue::set_listener (listener & l)
+    {
+        lock_type guard (_mutex);
+        if (_listener)
+        {
+            return ExitStatus::AlreadyExist;
+        }
+
+        _listener = &l;
+        if (!_queue.empty ())
+        {
+            _listener->notify (_id, this, notification_flag::data);
+        }
+        return ExitStatus::Success;
+    }
+
+    status_code bounded_message_queue::set_watermarks (const size_t high, const size_t low)
+    {
+        if (high && (high <= low))
+        {
+            return ExitStatus::InvalidArgument;
+        }
+
+        lock_type guard (_mutex);
+        _high_watermark = high;
+        _low_watermark = low;
+        _above_watermark = false;
+        return ExitStatus::Success;
+    }
+
+    size_t bounded_message_queue::get_size () const
+    {
+        return _size.load (std::memory_order_relaxed);
+    }
+
+    size_t bounded_message_queue::get_bytes () const
+    {
+        return _bytes.load (std::memory_order_relaxed);
+    }
+
+    size_t bounded_message_queue::get_max_messages () const
+    {
+        return _max_messages;
+    }
+
+    size_t bounded_message_queue::get_max_bytes () const
+    {
+        return _max_bytes;
+    }
+
+    bounded_message_queue::overflow_policy bounded_message_queue::get_policy () const
+    {
+        return _policy;
+    }
+
+    size_t bounded_message_queue::get_dropped_count () const
+    {
+        return _dropped.load (std::memory_order_relaxed);
+    }
+
+    size_t bounded_message_queue::get_rejected_count () const
+    {
+        return _rejected.load (std::memory_order_relaxed);
+    }
+} /* namespace mqmx */
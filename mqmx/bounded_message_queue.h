@@ -0,0 +1,228 @@
+#pragma once
+
+#include <mqmx/libexport.h>
+#include <mqmx/message_queue.h>
+#include <mqmx/wait_time_provider.h>
+
+#include <crs/condition_variable.h>
+
+#include <atomic>
+#include <functional>
+
+namespace mqmx
+{
+    /**
+     * \brief Message queue (FIFO) with limited capacity.
+     *
+     * Capacity is limited by the number of messages and (optionally) by the
+     * total size of messages. Size of message is provided by the user defined
+     * function, since messages of different types are stored in the same
+     * queue. A single message is always accepted by the empty queue, even if
+     * it's bigger than the limit.
+     *
+     * Push operation never blocks: message, which doesn't fit, is either
+     * rejected (ExitStatus::Overflow is returned and the message is left to
+     * the caller), or the oldest messages of the queue are dropped to free the
+     * space, or the new message is dropped instead (depending on the policy
+     * of the queue). Blocking version of push operation waits for free space
+     * for a given time first.
+     *
+     * If high watermark is set, the listener gets
+     * \link mqmx::message_queue::notification_flag::high_watermark \endlink
+     * notification when the number of messages reaches it and
+     * \link mqmx::message_queue::notification_flag::low_watermark \endlink
+     * notification when the number of messages falls back to low watermark.
+     *
+     * \note Objects of this class could not be moved.
+     */
+    class MQMX_EXPORT bounded_message_queue final : public message_queue
+    {
+        bounded_message_queue (const bounded_message_queue &) = delete;
+        bounded_message_queue & operator = (const bounded_message_queue &) = delete;
+        bounded_message_queue (bounded_message_queue &&) = delete;
+        bounded_message_queue & operator = (bounded_message_queue &&) = delete;
+
+    public:
+        typedef std::function<size_t(const message &)> message_size_func_type;
+        typedef crs::condvar_type                       condvar_type;
+
+        /**
+         * \brief Defines what happens with the message, which doesn't fit.
+         */
+        enum overflow_policy
+        {
+            reject      = 0, /*!< new message is rejected (backpressure) */
+            drop_oldest = 1, /*!< the oldest messages are dropped to free the space */
+            drop_newest = 2  /*!< new message is dropped */
+        };
+
+        /**
+         * \brief Constructor.
+         *
+         * \param max_messages is the maximum number of messages (zero means no limit)
+         * \param policy defines what happens with the message, which doesn't fit
+         * \param max_bytes is the maximum total size of messages (zero means no limit)
+         * \param size_of returns size of the message (required if max_bytes is set)
+         */
+        bounded_message_queue (const queue_id_type = message::undefined_qid,
+                               const size_t max_messages = 0,
+                               const overflow_policy policy = reject,
+                               const size_t max_bytes = 0,
+                               const message_size_func_type & size_of = message_size_func_type ());
+
+        /**
+         * \brief Destructor.
+         */
+        virtual ~bounded_message_queue ();
+
+        /**
+         * \brief Push some message to the end of the queue (without waiting).
+         *
+         * Same as \link mqmx::bounded_message_queue::try_push \endlink.
+         */
+        virtual status_code push (message::upointer_type &&) override;
+
+        /**
+         * \brief Push some message to the end of the queue (with waiting).
+         *
+         * Waits until message fits or timeout expires, then behaves
+         * as \link mqmx::bounded_message_queue::try_push \endlink, except
+         * that message, which still doesn't fit, is rejected with
+         * ExitStatus::Timeout.
+         */
+        status_code push (message::upointer_type && msg, const wait_time_provider & wtp);
+
+        /**
+         * \brief Push some message to the end of the queue (without waiting).
+         *
+         * \retval ExitStatus::Success          if message was pushed or dropped
+         *                                      according to the policy
+         * \retval ExitStatus::Overflow         if message doesn't fit and is rejected
+         *                                      (message is left intact)
+         * \retval ExitStatus::InvalidArgument  if argument is a nullptr
+         * \retval ExitStatus::NotSupported     if message passed as a parameter doesn't belong
+         *                                      to this message queue (has different QID)
+         */
+        status_code try_push (message::upointer_type &&);
+
+        /**
+         * \brief Remove and return message from the top of the queue.
+         */
+        virtual message::upointer_type pop () override;
+
+        using message_queue::push_batch;
+
+        /**
+         * \brief Push a batch of messages to the end of the queue.
+         *
+         * If batch doesn't fit as a whole, it's rejected as a whole in
+         * \link mqmx::bounded_message_queue::reject \endlink mode (batch
+         * is left intact and ExitStatus::Overflow is returned), otherwise
+         * messages are dropped one by one according to the policy.
+         *
+         * \see \link mqmx::message_queue::push_batch \endlink
+         */
+        virtual status_code push_batch (container_type & batch) override;
+
+        /**
+         * \brief Remove a number of messages from the top of the queue.
+         *
+         * \see \link mqmx::message_queue::drain \endlink
+         */
+        virtual size_t drain (container_type & out, const size_t max = static_cast<size_t> (-1)) override;
+
+        /**
+         * \brief Get the maximum number of messages, which consumer should
+         *        drain at once.
+         *
+         * Messages are taken out one by one, so they stay in the queue (and
+         * occupy its capacity) until consumer is ready to handle them. This
+         * way producers get backpressure of a slow consumer.
+         *
+         * \returns 1
+         */
+        virtual size_t get_drain_limit () const override;
+
+        /**
+         * \brief Sets new listener for this message queue.
+         *
+         * \see \link mqmx::message_queue::set_listener \endlink
+         */
+        virtual status_code set_listener (listener &) override;
+
+        /**
+         * \brief Set watermarks for notifications.
+         *
+         * \param high is the number of messages, which triggers high watermark
+         *        notification (zero disables notifications)
+         * \param low is the number of messages, which triggers low watermark
+         *        notification after high watermark was reached
+         *
+         * \retval ExitStatus::Success          if operation completed successfully
+         * \retval ExitStatus::InvalidArgument  if low watermark is not less than high one
+         */
+        status_code set_watermarks (const size_t high, const size_t low);
+
+        /**
+         * \brief Get the number of messages in the queue.
+         */
+        size_t get_size () const;
+
+        /**
+         * \brief Get the total size of messages in the queue.
+         */
+        size_t get_bytes () const;
+
+        /**
+         * \brief Get the maximum number of messages (zero if not limited).
+         */
+        size_t get_max_messages () const;
+
+        /**
+         * \brief Get the maximum total size of messages (zero if not limited).
+         */
+        size_t get_max_bytes () const;
+
+        /**
+         * \brief Get the policy for messages, which don't fit.
+         */
+        overflow_policy get_policy () const;
+
+        /**
+         * \brief Get the number of messages dropped according to the policy.
+         */
+        size_t get_dropped_count () const;
+
+        /**
+         * \brief Get the number of messages rejected (or timed out).
+         */
+        size_t get_rejected_count () const;
+
+    private:
+        size_t size_of (const message &) const;
+        status_code push_locked (message::upointer_type && msg);
+        bool fits (const size_t count, const size_t bytes) const;
+        void append (message::upointer_type && msg, const size_t bytes);
+        message::upointer_type remove_front ();
+        void shed (const size_t count, const size_t bytes);
+        void notify_pushed (const bool was_empty);
+        void notify_popped ();
+
+        const size_t                 _max_messages;
+        const size_t                 _max_bytes;
+        const overflow_policy        _policy;
+        const message_size_func_type _size_of;
+        container_type               _queue;
+        size_t                       _high_watermark;
+        size_t                       _low_watermark;
+        bool                         _above_watermark;
+        size_t                       _waiters;     /* producers waiting for free space */
+        condvar_type                 _space;
+
+        /* modified with mutex acquired, could be read without it */
+        std::atomic<size_t>          _size;
+        std::atomic<size_t>          _bytes;
+        std::atomic<size_t>          _dropped;
+        std::atomic<size_t>          _rejected;
+    };
+} /* namespace mqmx */
@@ -0,0 +1,47 @@
+#include <mqmx/eventfd_poll_listener.h>
+
+#if defined(__linux__)
+
+#include <cstdint>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+namespace mqmx
+{
+    eventfd_poll_listener::eventfd_poll_listener (const listener_mode mode,
+                                                  const queue_id_type qid_hint)
+        : message_queue_poll_listener (mode, qid_hint)
+        , _fd (::eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC))
+    {
+    }
+
+    eventfd_poll_listener::~eventfd_poll_listener ()
+    {
+        if (_fd >= 0)
+        {
+            ::close (_fd);
+        }
+    }
+
+    void eventfd_poll_listener::notifications_pending ()
+    {
+        if (_fd >= 0)
+        {
+            const uint64_t increment = 1;
+            if (::write (_fd, &increment, sizeof (increment)) < 0)
+            { /* counter overflow is not possible - it's reset on every take */ }
+        }
+    }
+
+    void eventfd_poll_listener::notifications_taken ()
+    {
+        if (_fd >= 0)
+        {
+            uint64_t counter = 0;
+            if (::read (_fd, &counter, sizeof (counter)) < 0)
+            { /* descriptor is not readable already */ }
+        }
+    }
+} /* namespace mqmx */
+
+#endif /* __linux__ */
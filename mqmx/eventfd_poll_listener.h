@@ -0,0 +1,64 @@
+#pragma once
+
+#include <mqmx/libexport.h>
+#include <mqmx/message_queue_poll.h>
+
+#if defined(__linux__)
+
+namespace mqmx
+{
+    /**
+     * \brief Poll listener with readable file descriptor (Linux only).
+     *
+     * In addition to the list of notifications this listener keeps an
+     * eventfd, which is readable as long as the list is not empty. So
+     * message queues might be waited for together with sockets and other
+     * file descriptors in the same select/poll/epoll loop, without a
+     * dedicated thread (like the one of \link mqmx::message_queue_pool \endlink).
+     *
+     * Typical usage is to wait for the descriptor to become readable, then
+     * take notifications out of the listener and drain notified queues.
+     *
+     * \note \link mqmx::message_queue::notification_flag::data \endlink
+     *       notification is delivered only for push into the empty queue,
+     *       so notified queues should be drained completely.
+     */
+    class MQMX_EXPORT eventfd_poll_listener final : public message_queue_poll_listener
+    {
+        int _fd;
+
+        virtual void notifications_pending () override;
+        virtual void notifications_taken () override;
+
+    public:
+        /**
+         * \brief Constructor.
+         *
+         * \param mode defines the way notifications are stored
+         * \param qid_hint is the expected biggest message queue ID
+         */
+        explicit eventfd_poll_listener (const listener_mode mode = ready_list,
+                                        const queue_id_type qid_hint = 0);
+
+        /**
+         * \brief Destructor.
+         */
+        virtual ~eventfd_poll_listener ();
+
+        /**
+         * \brief Get file descriptor of this listener.
+         *
+         * Descriptor is non-blocking and readable (POLLIN/EPOLLIN) while
+         * there are notifications not taken out of the listener. It should
+         * not be read by the user.
+         *
+         * \returns file descriptor or -1 if eventfd could not be created
+         */
+        int get_fd () const
+        {
+            return _fd;
+        }
+    };
+} /* namespace mqmx */
+
+#endif /* __linux__ */
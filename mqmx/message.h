@@ -2,7 +2,11 @@
 
 #include <mqmx/libexport.h>
 #include <mqmx/types.h>
+#include <mqmx/message_allocator.h>
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <new>
 
 namespace mqmx
 {
@@ -13,11 +17,25 @@ namespace mqmx
      * First is needed to specify to which queue this message belongs and because
      * of this there is no possibility to put message from one queue to the queue with
      * different ID. Second - provides the information for proper message deserialization.
+     *
+     * Memory for objects of this class and all derived classes is allocated by the
+     * \link mqmx::message_allocator \endlink, so messages created by one thread and
+     * destroyed by another don't go through the global heap.
+     *
+     * Blocks of the allocator are aligned to the alignment of any message type,
+     * which fits into its size classes. Bigger over-aligned messages are passed
+     * to the aligned global operator new if compiler supports it (C++17 or
+     * -faligned-new).
      */
     class MQMX_EXPORT message
     {
+        friend class mpsc_message_queue;
+        friend class queue_stats;
+
         const queue_id_type _qid;
         const message_id_type _mid;
+        std::atomic<message *> _next; /* intrusive link for lock-free queues */
+        uint64_t _stamp;              /* push time (if queue keeps statistics) or zero */
 
     public:
         typedef std::unique_ptr<message> upointer_type;
@@ -28,6 +46,21 @@ namespace mqmx
                  const message_id_type message_id)
             : _qid (queue_id)
             , _mid (message_id)
+            , _next (nullptr)
+            , _stamp (0)
+        {
+        }
+
+        /**
+         * \brief Copy constructor.
+         *
+         * Intrusive link is never copied, so the copy doesn't belong to any queue.
+         */
+        message (const message & o)
+            : _qid (o._qid)
+            , _mid (o._mid)
+            , _next (nullptr)
+            , _stamp (0)
         {
         }
 
@@ -35,6 +68,85 @@ namespace mqmx
         {
         }
 
+        static void * operator new (std::size_t size)
+        {
+            return message_allocator::allocate (size);
+        }
+
+        static void * operator new (std::size_t size, const std::nothrow_t &) noexcept
+        {
+            try
+            {
+                return message_allocator::allocate (size);
+            }
+            catch (...)
+            {
+                return nullptr;
+            }
+        }
+
+        static void * operator new (std::size_t, void * ptr) noexcept
+        {
+            return ptr;
+        }
+
+        static void operator delete (void * ptr, std::size_t size) noexcept
+        {
+            message_allocator::deallocate (ptr, size);
+        }
+
+        /* called if constructor of the message created by nothrow new throws */
+        static void operator delete (void * ptr, const std::nothrow_t &) noexcept
+        {
+            message_allocator::deallocate (ptr);
+        }
+
+        static void operator delete (void *, void *) noexcept
+        {
+        }
+
+#if defined (__cpp_aligned_new)
+        static void * operator new (std::size_t size, std::align_val_t alignment)
+        {
+            return (size <= message_allocator::MAX_BLOCK_SIZE)
+                ? message_allocator::allocate (size)
+                : ::operator new (size, alignment);
+        }
+
+        static void * operator new (std::size_t size, std::align_val_t alignment,
+                                    const std::nothrow_t & tag) noexcept
+        {
+            return (size <= message_allocator::MAX_BLOCK_SIZE)
+                ? operator new (size, tag)
+                : ::operator new (size, alignment, tag);
+        }
+
+        static void operator delete (void * ptr, std::size_t size, std::align_val_t alignment) noexcept
+        {
+            if (size <= message_allocator::MAX_BLOCK_SIZE)
+            {
+                message_allocator::deallocate (ptr, size);
+            }
+            else
+            {
+                ::operator delete (ptr, alignment);
+            }
+        }
+
+        static void operator delete (void * ptr, std::align_val_t alignment,
+                                     const std::nothrow_t &) noexcept
+        {
+            if (message_allocator::get_block_size (ptr))
+            {
+                message_allocator::deallocate (ptr);
+            }
+            else
+            {
+                ::operator delete (ptr, alignment);
+            }
+        }
+#endif
+
         /**
          * \returns ID of the queue to which this message belongs
          */
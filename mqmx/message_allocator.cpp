@@ -0,0 +1,315 @@
+#include <mqmx/message_allocator.h>
+#include <mqmx/types.h>
+
+#include <crs/mutex.h>
+
+#include <cstdint>
+#include <map>
+#include <new>
+
+namespace mqmx
+{
+    const size_t message_allocator::GRANULARITY = 32;
+    const size_t message_allocator::MAX_BLOCK_SIZE = 512;
+
+    namespace
+    {
+        const size_t NCLASSES = 16;           /* MAX_BLOCK_SIZE / GRANULARITY */
+        const size_t MAX_CACHED_BLOCKS = 256; /* per size class in thread cache */
+        const size_t TRANSFER_BATCH = 64;     /* blocks moved to/from central list */
+        const size_t SLAB_SIZE = 64 * 1024;   /* memory requested from the system */
+
+        struct free_block
+        {
+            free_block * next;
+        };
+
+        /*
+         * Process-wide lists of free blocks (one for each size class).
+         */
+        class central_heap
+        {
+            struct free_list
+            {
+                crs::mutex_type mutex;
+                free_block *    head;
+                char            pad[cache_line_size];
+            };
+
+            typedef std::map<const char *, size_t> slabs_map_type;
+
+            free_list       _lists[NCLASSES];
+            crs::mutex_type _slabs_mutex;
+            slabs_map_type  _slabs; /* size class of each slab by its address */
+
+            /*
+             * Slab is aligned to the biggest block, so each block is aligned
+             * to the biggest power of two its size is divisible by. Since size
+             * of a type is a multiple of its alignment, any type which fits
+             * into size class is properly aligned (over-aligned ones too).
+             */
+            char * allocate_slab (const size_t cls)
+            {
+                const size_t alignment = message_allocator::MAX_BLOCK_SIZE;
+                char * raw = static_cast<char *> (::operator new (SLAB_SIZE + alignment));
+                const size_t misalignment = reinterpret_cast<uintptr_t> (raw) % alignment;
+                char * slab = raw + (misalignment ? alignment - misalignment : 0);
+                try
+                {
+                    crs::lock_type guard (_slabs_mutex);
+                    _slabs.emplace (slab, cls);
+                }
+                catch (...)
+                {
+                    ::operator delete (raw);
+                    throw;
+                }
+                return slab;
+            }
+
+        public:
+            central_heap ()
+                : _lists ()
+                , _slabs_mutex ()
+                , _slabs ()
+            { }
+
+            /*
+             * Fetches up to TRANSFER_BATCH blocks, returns number of fetched blocks.
+             */
+            size_t fetch (const size_t cls, free_block * & head)
+            {
+                free_list & list = _lists[cls];
+                {
+                    crs::lock_type guard (list.mutex);
+                    if (list.head)
+                    {
+                        size_t count = 1;
+                        free_block * last = list.head;
+                        for (; (count < TRANSFER_BATCH) && last->next; ++count)
+                        {
+                            last = last->next;
+                        }
+                        head = list.head;
+                        list.head = last->next;
+                        last->next = nullptr;
+                        return count;
+                    }
+                }
+
+                /* carve new slab into blocks of given size class */
+                const size_t block_size = (cls + 1) * message_allocator::GRANULARITY;
+                char * slab = allocate_slab (cls);
+                const size_t nblocks = SLAB_SIZE / block_size;
+                for (size_t ix = 0; ix < nblocks; ++ix)
+                {
+                    free_block * block = reinterpret_cast<free_block *> (slab + ix * block_size);
+                    block->next = (ix + 1 < nblocks)
+                        ? reinterpret_cast<free_block *> (slab + (ix + 1) * block_size)
+                        : nullptr;
+                }
+
+                head = reinterpret_cast<free_block *> (slab);
+                if (nblocks <= TRANSFER_BATCH)
+                {
+                    return nblocks;
+                }
+
+                /* the rest of the slab goes to the central list */
+                free_block * last = reinterpret_cast<free_block *> (
+                    slab + (TRANSFER_BATCH - 1) * block_size);
+                free_block * rest = last->next;
+                last->next = nullptr;
+                release (cls, rest, reinterpret_cast<free_block *> (
+                             slab + (nblocks - 1) * block_size));
+                return TRANSFER_BATCH;
+            }
+
+            void release (const size_t cls, free_block * first, free_block * last)
+            {
+                free_list & list = _lists[cls];
+                crs::lock_type guard (list.mutex);
+                last->next = list.head;
+                list.head = first;
+            }
+
+            size_t find_block_size (const void * ptr)
+            {
+                const char * const p = static_cast<const char *> (ptr);
+                crs::lock_type guard (_slabs_mutex);
+                auto it = _slabs.upper_bound (p);
+                if (it == std::begin (_slabs))
+                {
+                    return 0;
+                }
+
+                --it;
+                return (p < it->first + SLAB_SIZE)
+                    ? (it->second + 1) * message_allocator::GRANULARITY
+                    : 0;
+            }
+        };
+
+        central_heap & get_central_heap ()
+        {
+            /* never destroyed, so messages could be released at any time */
+            static central_heap * heap = new central_heap ();
+            return *heap;
+        }
+
+        /*
+         * Thread cache is trivially destructible, so it stays accessible until
+         * the very end of the thread. Separate guard returns its blocks to the
+         * central heap at thread exit.
+         */
+        struct thread_cache
+        {
+            free_block * head[NCLASSES];
+            size_t       count[NCLASSES];
+            bool         registered;
+            bool         dead;
+        };
+
+        thread_local thread_cache tcache;
+
+        void flush (const size_t cls, const size_t nkeep)
+        {
+            if (tcache.count[cls] <= nkeep)
+            {
+                return;
+            }
+
+            /* most recently released (hot) blocks are kept in cache */
+            free_block * first = tcache.head[cls];
+            if (nkeep)
+            {
+                free_block * keep_last = first;
+                for (size_t n = nkeep; 1 < n; --n)
+                {
+                    keep_last = keep_last->next;
+                }
+                first = keep_last->next;
+                keep_last->next = nullptr;
+            }
+            else
+            {
+                tcache.head[cls] = nullptr;
+            }
+
+            free_block * last = first;
+            while (last->next)
+            {
+                last = last->next;
+            }
+            tcache.count[cls] = nkeep;
+            get_central_heap ().release (cls, first, last);
+        }
+
+        struct thread_cache_guard
+        {
+            ~thread_cache_guard ()
+            {
+                for (size_t cls = 0; cls < NCLASSES; ++cls)
+                {
+                    flush (cls, 0);
+                }
+                tcache.dead = true;
+            }
+        };
+
+        thread_local thread_cache_guard tguard;
+
+        void register_thread_cache ()
+        {
+            if (!tcache.registered)
+            {
+                tcache.registered = true;
+                (void) &tguard; /* odr-use forces construction of the guard */
+            }
+        }
+    } /* namespace */
+
+    void * message_allocator::allocate (const size_t size)
+    {
+        const size_t cls = (size ? size - 1 : 0) / GRANULARITY;
+        if (NCLASSES <= cls)
+        {
+            return ::operator new (size);
+        }
+
+        if (tcache.dead)
+        {
+            free_block * head = nullptr;
+            const size_t count = get_central_heap ().fetch (cls, head);
+            if (1 < count)
+            {
+                free_block * last = head->next;
+                while (last->next)
+                {
+                    last = last->next;
+                }
+                get_central_heap ().release (cls, head->next, last);
+            }
+            return head;
+        }
+
+        if (tcache.head[cls] == nullptr)
+        {
+            register_thread_cache ();
+            tcache.count[cls] = get_central_heap ().fetch (cls, tcache.head[cls]);
+        }
+
+        free_block * block = tcache.head[cls];
+        tcache.head[cls] = block->next;
+        --tcache.count[cls];
+        return block;
+    }
+
+    size_t message_allocator::get_block_size (const void * ptr) noexcept
+    {
+        return (ptr == nullptr) ? 0 : get_central_heap ().find_block_size (ptr);
+    }
+
+    void message_allocator::deallocate (void * ptr, const size_t size) noexcept
+    {
+        if (ptr == nullptr)
+        {
+            return;
+        }
+
+        const size_t cls = (size ? size - 1 : 0) / GRANULARITY;
+        if (NCLASSES <= cls)
+        {
+            ::operator delete (ptr);
+            return;
+        }
+
+        free_block * block = static_cast<free_block *> (ptr);
+        if (tcache.dead)
+        {
+            get_central_heap ().release (cls, block, block);
+            return;
+        }
+
+        register_thread_cache ();
+        block->next = tcache.head[cls];
+        tcache.head[cls] = block;
+        if (MAX_CACHED_BLOCKS < ++tcache.count[cls])
+        {
+            flush (cls, MAX_CACHED_BLOCKS / 2);
+        }
+    }
+
+    void message_allocator::deallocate (void * ptr) noexcept
+    {
+        const size_t size = get_block_size (ptr);
+        if (size)
+        {
+            deallocate (ptr, size);
+        }
+        else
+        {
+            ::operator delete (ptr);
+        }
+    }
+} /* namespace mqmx */
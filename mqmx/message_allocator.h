@@ -0,0 +1,71 @@
+#pragma once
+
+#include <mqmx/libexport.h>
+#include <cstddef>
+
+namespace mqmx
+{
+    /**
+     * \brief Memory allocator for messages.
+     *
+     * Allocator keeps memory blocks in a number of size classes. Each thread
+     * has its own cache of free blocks for each size class, so in most cases
+     * allocation and deallocation is just an operation on thread local list.
+     * When thread cache of some size class is empty it is refilled from the
+     * central (process-wide) list, and when it grows over the limit, part of
+     * the blocks is returned to the central list. This way blocks allocated by
+     * producer thread and released by consumer thread are eventually returned
+     * to the producer side.
+     *
+     * Blocks larger than the biggest size class are served by global operators
+     * new and delete. Memory of size classes is never returned to the system,
+     * but it is reused for subsequent allocations.
+     *
+     * Block of size class is aligned to the biggest power of two (up to
+     * MAX_BLOCK_SIZE) its size is divisible by, so it's properly aligned for
+     * any type of the same size, including over-aligned ones.
+     *
+     * \see \link mqmx::message \endlink which uses this allocator for all
+     *      derived classes.
+     */
+    class MQMX_EXPORT message_allocator final
+    {
+    public:
+        static const size_t GRANULARITY;     ///< difference between adjacent size classes
+        static const size_t MAX_BLOCK_SIZE;  ///< size of the biggest size class
+
+        message_allocator () = delete;
+
+        /**
+         * \brief Allocate memory block of at least given size.
+         *
+         * \throws std::bad_alloc in case of memory exhaustion
+         */
+        static void * allocate (const size_t size);
+
+        /**
+         * \brief Release memory block.
+         *
+         * \param ptr is a pointer returned by \link mqmx::message_allocator::allocate \endlink
+         * \param size is the same size as was requested for this block
+         */
+        static void deallocate (void * ptr, const size_t size) noexcept;
+
+        /**
+         * \brief Release memory block of unknown size.
+         *
+         * Size class is looked up by the address of the block, so this call is
+         * much slower than the sized one. It is intended for rare cases like
+         * failed construction of the message created by nothrow new.
+         */
+        static void deallocate (void * ptr) noexcept;
+
+        /**
+         * \brief Get size of the block of size class.
+         *
+         * \returns Size of the size class, which block belongs to, or zero if
+         *          block was allocated by global operator new
+         */
+        static size_t get_block_size (const void * ptr) noexcept;
+    };
+} /* namespace mqmx */
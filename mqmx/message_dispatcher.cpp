@@ -0,0 +1,52 @@
+#include <mqmx/message_dispatcher.h>
+
+namespace mqmx
+{
+    message_dispatcher::message_dispatcher (const fallback_func_type & fallback)
+        : _table ()
+        , _fallback (fallback)
+    {
+    }
+
+    message_dispatcher::message_dispatcher (const message_dispatcher & other)
+        : _table ()
+        , _fallback (other._fallback)
+    {
+        _table.reserve (other._table.size ());
+        for (const auto & entry : other._table)
+        {
+            _table.emplace_back (entry ? entry->clone () : nullptr);
+        }
+    }
+
+    message_dispatcher & message_dispatcher::operator = (const message_dispatcher & other)
+    {
+        if (this != &other)
+        {
+            message_dispatcher copy (other);
+            std::swap (_table, copy._table);
+            std::swap (_fallback, copy._fallback);
+        }
+        return *this;
+    }
+
+    status_code message_dispatcher::set_entry (const message_id_type mid, entry_type && entry)
+    {
+        if (_table.size () <= mid)
+        {
+            _table.resize (mid + 1);
+        }
+        else if (_table[mid])
+        {
+            return ExitStatus::AlreadyExist;
+        }
+
+        _table[mid] = std::move (entry);
+        return ExitStatus::Success;
+    }
+
+    bool message_dispatcher::has_handler (const message_id_type mid) const
+    {
+        return (mid < _table.size ()) && _table[mid];
+    }
+} /* namespace mqmx */
@@ -0,0 +1,352 @@
+#pragma once
+
+#include <mqmx/libexport.h>
+#include <mqmx/message.h>
+
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace mqmx
+{
+    /**
+     * \brief Dispatcher of messages to handlers by message ID.
+     *
+     * Handler is registered for a particular message ID along with the type
+     * of message, so it gets the message already downcast to this type:
+     *
+     * \code
+     * dispatcher.set_handler<foo_message> (FOO_MESSAGE_ID,
+     *                                      [](foo_message & msg) { ...; return ExitStatus::Success; });
+     * \endcode
+     *
+     * Handlers are kept in a table addressed by message ID, so dispatching
+     * costs a single indirect call. Table grows up to the biggest registered
+     * ID, so this class is intended for dense message IDs. Messages without
+     * registered handler are passed to the fallback handler (if any).
+     *
+     * Message is destroyed right after the handler returns.
+     *
+     * Handlers are owned by the dispatcher and copied along with it (like
+     * std::function does), so each copy could be used by its own thread.
+     * Dispatching is not thread-safe by itself.
+     *
+     * Dispatcher could be used as a handler of message queue of
+     * \link mqmx::message_queue_pool \endlink, in this case pool calls
+     * dispatcher directly.
+     *
+     * \see \link mqmx::static_message_dispatcher \endlink
+     */
+    class MQMX_EXPORT message_dispatcher
+    {
+    public:
+        typedef std::function<status_code(message::upointer_type &&)> fallback_func_type;
+
+    private:
+        struct handler_base
+        {
+            virtual ~handler_base ()
+            { }
+
+            virtual status_code call (message &) = 0;
+            virtual handler_base * clone () const = 0;
+        };
+
+        template <typename message_type, typename handler_type>
+        struct handler_holder : handler_base
+        {
+            handler_type handler;
+
+            template <typename func_type>
+            explicit handler_holder (func_type && func)
+                : handler (std::forward<func_type> (func))
+            { }
+
+            virtual status_code call (message & msg) override
+            {
+                return handler (static_cast<message_type &> (msg));
+            }
+
+            virtual handler_base * clone () const override
+            {
+                return new handler_holder (handler);
+            }
+        };
+
+        typedef std::unique_ptr<handler_base> entry_type;
+        typedef std::vector<entry_type>       table_type;
+
+        status_code set_entry (const message_id_type mid, entry_type && entry);
+
+        table_type         _table;
+        fallback_func_type _fallback;
+
+    public:
+        /**
+         * \brief Constructor.
+         *
+         * \param fallback is called for messages without registered handler
+         */
+        explicit message_dispatcher (const fallback_func_type & fallback = fallback_func_type ());
+
+        /**
+         * \brief Copy constructor.
+         *
+         * Handlers are copied, so the copy doesn't share their state with
+         * the original dispatcher.
+         */
+        message_dispatcher (const message_dispatcher &);
+        message_dispatcher & operator = (const message_dispatcher &);
+        message_dispatcher (message_dispatcher &&) = default;
+        message_dispatcher & operator = (message_dispatcher &&) = default;
+
+        /**
+         * \brief Register handler for messages with given ID.
+         *
+         * Handler is called as status_code (message_type &).
+         *
+         * \retval ExitStatus::Success       if operation completed successfully
+         * \retval ExitStatus::AlreadyExist  if handler for this ID is already registered
+         */
+        template <typename message_type, typename handler_type>
+        status_code set_handler (const message_id_type mid, handler_type && handler)
+        {
+            static_assert (std::is_base_of<message, message_type>::value,
+                           "Invalid message_type - should be derived from mqmx::message");
+            typedef typename std::decay<handler_type>::type stored_type;
+            return set_entry (mid, entry_type (
+                                  new handler_holder<message_type, stored_type> (
+                                      std::forward<handler_type> (handler))));
+        }
+
+        /**
+         * \brief Check whether handler for messages with given ID is registered.
+         */
+        bool has_handler (const message_id_type mid) const;
+
+        /**
+         * \brief Pass message to its handler.
+         *
+         * \returns Status code returned by the handler or ExitStatus::NotFound
+         *          if there is neither handler for this message nor fallback
+         *          handler (ExitStatus::InvalidArgument if message is nullptr)
+         */
+        status_code dispatch (message::upointer_type && msg)
+        {
+            if (!msg)
+            {
+                return ExitStatus::InvalidArgument;
+            }
+
+            const message_id_type mid = msg->get_mid ();
+            if ((mid < _table.size ()) && _table[mid])
+            {
+                return _table[mid]->call (*msg);
+            }
+            return _fallback ? _fallback (std::move (msg)) : ExitStatus::NotFound;
+        }
+    };
+
+    namespace detail
+    {
+        /* C++11 replacement of std::index_sequence */
+        template <size_t... ix>
+        struct index_sequence
+        { };
+
+        template <typename, typename>
+        struct concat_index_sequence;
+
+        template <size_t... lhs, size_t... rhs>
+        struct concat_index_sequence<index_sequence<lhs...>, index_sequence<rhs...>>
+        {
+            typedef index_sequence<lhs..., (sizeof... (lhs) + rhs)...> type;
+        };
+
+        /* sequence is built in halves, so depth of instantiation is logarithmic */
+        template <size_t N>
+        struct make_index_sequence
+        {
+            typedef typename concat_index_sequence<
+                typename make_index_sequence<N / 2>::type,
+                typename make_index_sequence<N - N / 2>::type>::type type;
+        };
+
+        template <>
+        struct make_index_sequence<0>
+        {
+            typedef index_sequence<> type;
+        };
+
+        template <>
+        struct make_index_sequence<1>
+        {
+            typedef index_sequence<0> type;
+        };
+
+        template <typename T>
+        constexpr T greater_of (const T lhs, const T rhs)
+        {
+            return (lhs < rhs) ? rhs : lhs;
+        }
+
+        template <typename T>
+        constexpr T max_of (const T value)
+        {
+            return value;
+        }
+
+        template <typename T, typename... rest>
+        constexpr T max_of (const T value, const rest... values)
+        {
+            return greater_of (value, max_of (values...));
+        }
+
+        template <typename T>
+        constexpr T first_non_null (const T value)
+        {
+            return value;
+        }
+
+        template <typename T, typename... rest>
+        constexpr T first_non_null (const T value, const rest... values)
+        {
+            return value ? value : first_non_null (values...);
+        }
+    } /* namespace detail */
+
+    /**
+     * \brief Binding of message ID to message type.
+     *
+     * \see \link mqmx::static_message_dispatcher \endlink
+     */
+    template <message_id_type MID, typename message_type>
+    struct message_binding
+    {
+        static_assert (std::is_base_of<message, message_type>::value,
+                       "Invalid message_type - should be derived from mqmx::message");
+
+        static constexpr message_id_type mid = MID;
+        typedef message_type type;
+    };
+
+    /**
+     * \brief Dispatcher of messages, which table is built at compile time.
+     *
+     * Messages are dispatched to the visitor, which provides function call
+     * operator for each message type of the bindings list:
+     *
+     * \code
+     * struct visitor
+     * {
+     *     status_code operator () (foo_message &);
+     *     status_code operator () (bar_message &);
+     * };
+     *
+     * static_message_dispatcher<visitor,
+     *                           message_binding<FOO_MESSAGE_ID, foo_message>,
+     *                           message_binding<BAR_MESSAGE_ID, bar_message>> dispatcher;
+     * \endcode
+     *
+     * Table of calls is a constant addressed by message ID, so calls of the
+     * visitor could be inlined. Dispatcher is a handler of message queue by
+     * itself, so it could be passed to
+     * \link mqmx::message_queue_pool::allocate_queue \endlink directly.
+     */
+    template <typename visitor_type, typename... bindings>
+    class static_message_dispatcher
+    {
+        static_assert (sizeof... (bindings) > 0, "At least one binding is required");
+
+        typedef status_code (*thunk_type)(visitor_type &, message &);
+
+        static constexpr message_id_type max_mid ()
+        {
+            return detail::max_of (bindings::mid...);
+        }
+
+        template <typename binding>
+        static status_code invoke (visitor_type & visitor, message & msg)
+        {
+            return visitor (static_cast<typename binding::type &> (msg));
+        }
+
+        template <typename binding>
+        static constexpr thunk_type thunk_of (const message_id_type mid)
+        {
+            return (binding::mid == mid) ? &static_message_dispatcher::invoke<binding> : nullptr;
+        }
+
+        static constexpr thunk_type entry_of (const message_id_type mid)
+        {
+            return detail::first_non_null (thunk_of<bindings> (mid)...);
+        }
+
+        struct table_type
+        {
+            thunk_type entries[max_mid () + 1];
+
+            template <size_t... ix>
+            constexpr table_type (detail::index_sequence<ix...>)
+                : entries {entry_of (ix)...}
+            { }
+        };
+
+        static constexpr table_type TABLE {
+            typename detail::make_index_sequence<max_mid () + 1>::type ()};
+
+        visitor_type _visitor;
+
+    public:
+        /**
+         * \brief Constructor.
+         */
+        explicit static_message_dispatcher (const visitor_type & visitor = visitor_type ())
+            : _visitor (visitor)
+        { }
+
+        /**
+         * \brief Get the visitor.
+         */
+        visitor_type & get_visitor ()
+        {
+            return _visitor;
+        }
+
+        /**
+         * \brief Pass message to the visitor.
+         *
+         * \returns Status code returned by the visitor or ExitStatus::NotFound
+         *          if message ID is not bound (ExitStatus::InvalidArgument if
+         *          message is nullptr)
+         */
+        status_code dispatch (message::upointer_type && msg)
+        {
+            if (!msg)
+            {
+                return ExitStatus::InvalidArgument;
+            }
+
+            const message_id_type mid = msg->get_mid ();
+            if ((mid <= max_mid ()) && TABLE.entries[mid])
+            {
+                return (TABLE.entries[mid]) (_visitor, *msg);
+            }
+            return ExitStatus::NotFound;
+        }
+
+        /**
+         * \brief Same as \link mqmx::static_message_dispatcher::dispatch \endlink.
+         */
+        status_code operator () (message::upointer_type && msg)
+        {
+            return dispatch (std::move (msg));
+        }
+    };
+
+    template <typename visitor_type, typename... bindings>
+    constexpr typename static_message_dispatcher<visitor_type, bindings...>::table_type
+    static_message_dispatcher<visitor_type, bindings...>::TABLE;
+} /* namespace mqmx */
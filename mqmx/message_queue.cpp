@@ -6,20 +6,23 @@ namespace mqmx
     message_queue::message_queue (const queue_id_type ID)
         : _id (ID)
         , _mutex ()
-        , _queue ()
         , _listener (nullptr)
+        , _stats (nullptr)
+        , _queue ()
     {
     }
 
     message_queue::message_queue (message_queue && o)
         : _id (message::undefined_qid)
         , _mutex ()
-        , _queue ()
         , _listener (nullptr)
+        , _stats (nullptr)
+        , _queue ()
     {
         lock_type guard (o._mutex);
         std::swap (_queue, o._queue);
         std::swap (_id, o._id);
+        std::swap (_stats, o._stats);
         std::swap (_listener, o._listener);
         if (_listener)
         {
@@ -44,8 +47,10 @@ namespace mqmx
             }
             _queue.clear ();
             _id = message::undefined_qid;
+            _stats = nullptr;
             std::swap (_queue, o._queue);
             std::swap (_id, o._id);
+            std::swap (_stats, o._stats);
             std::swap (_listener, o._listener);
             if (_listener)
             {
@@ -85,6 +90,10 @@ namespace mqmx
             return ExitStatus::NotSupported;
         }
 
+        if (_stats)
+        {
+            _stats->pushed (*msg);
+        }
         _queue.push_back (std::move (msg));
         if (_listener && (_queue.size () == 1))
         {
@@ -102,10 +111,116 @@ namespace mqmx
         {
             msg = std::move (_queue.front ());
             _queue.pop_front ();
+            if (_stats)
+            {
+                _stats->popped (*msg);
+            }
         }
         return msg;
     }
 
+    status_code message_queue::push_batch (container_type & batch)
+    {
+        for (const auto & msg : batch)
+        {
+            if (msg.get () == nullptr)
+            {
+                return ExitStatus::InvalidArgument;
+            }
+        }
+
+        lock_type guard (_mutex);
+        if (_id == message::undefined_qid)
+        {
+            return ExitStatus::NotSupported;
+        }
+
+        for (const auto & msg : batch)
+        {
+            if (_id != msg->get_qid ())
+            {
+                return ExitStatus::NotSupported;
+            }
+        }
+
+        if (batch.empty ())
+        {
+            return ExitStatus::Success;
+        }
+
+        if (_stats)
+        {
+            for (const auto & msg : batch)
+            {
+                _stats->pushed (*msg);
+            }
+        }
+
+        const bool was_empty = _queue.empty ();
+        if (was_empty)
+        {
+            std::swap (_queue, batch);
+        }
+        else
+        {
+            _queue.insert (std::end (_queue),
+                           std::make_move_iterator (std::begin (batch)),
+                           std::make_move_iterator (std::end (batch)));
+            batch.clear ();
+        }
+
+        if (_listener && was_empty)
+        {
+            /* only first message will be reported */
+            _listener->notify (_id, this, notification_flag::data);
+        }
+        return ExitStatus::Success;
+    }
+
+    size_t message_queue::drain (container_type & out, const size_t max)
+    {
+        lock_type guard (_mutex);
+        if (_id == message::undefined_qid)
+        {
+            return 0;
+        }
+
+        const size_t count = std::min (max, _queue.size ());
+        if ((count == _queue.size ()) && out.empty ())
+        {
+            std::swap (_queue, out);
+        }
+        else
+        {
+            const auto last = std::next (std::begin (_queue), count);
+            out.insert (std::end (out),
+                        std::make_move_iterator (std::begin (_queue)),
+                        std::make_move_iterator (last));
+            _queue.erase (std::begin (_queue), last);
+        }
+
+        if (_stats)
+        {
+            for (auto it = std::prev (std::end (out), count); it != std::end (out); ++it)
+            {
+                _stats->popped (**it);
+            }
+        }
+        return count;
+    }
+
+    size_t message_queue::get_drain_limit () const
+    {
+        return static_cast<size_t> (-1);
+    }
+
+    message_queue::container_type message_queue::pop_all ()
+    {
+        container_type result;
+        drain (result);
+        return result;
+    }
+
     status_code message_queue::set_listener (listener & l)
     {
         lock_type guard (_mutex);
@@ -127,4 +242,15 @@ namespace mqmx
         lock_type guard (_mutex);
         _listener = nullptr;
     }
+
+    void message_queue::set_stats (queue_stats * stats)
+    {
+        lock_type guard (_mutex);
+        _stats = stats;
+    }
+
+    queue_stats * message_queue::get_stats () const
+    {
+        return _stats;
+    }
 } /* namespace mqmx */
@@ -2,10 +2,13 @@
 
 #include <mqmx/libexport.h>
 #include <mqmx/message.h>
+#include <mqmx/queue_stats.h>
 
 #include <crs/mutex.h>
 
+#include <algorithm>
 #include <deque>
+#include <iterator>
 #include <type_traits>
 
 namespace mqmx
@@ -16,12 +19,16 @@ namespace mqmx
      * In addition to the classical implementation of message queue this class
      * also supports a single listener (observer). And if this listener is set,
      * message queue will send notifications to it about some changes in state
-     * of the object. Currently only three notifications supported and they are
+     * of the object. Supported notifications are
      * described by the \link mqmx::message_queue::notification_flag \endlink
      * enumerator.
      *
      * \note All notifications are used for the purpose of internal implementation,
      *       but you may find them usefull for some other purposes.
+     *
+     * Storage of messages is implemented as a mutex protected container, yet
+     * derived classes may provide different storage (backend) by overriding
+     * virtual members of this class, e.g. \link mqmx::mpsc_message_queue \endlink.
      */
     class MQMX_EXPORT message_queue
     {
@@ -37,11 +44,17 @@ namespace mqmx
 
         enum notification_flag
         {
-            data     = 0x0001, /*!< push operation called on this queue */
-            detached = 0x0002, /*!< move ctor or move assignment called on this queue
-                                * and the queue is no longer usable
-                                */
-            closed   = 0x0004  /*!< destructor called on this queue */
+            data           = 0x0001, /*!< push operation called on this queue */
+            detached       = 0x0002, /*!< move ctor or move assignment called on this queue
+                                      * and the queue is no longer usable
+                                      */
+            closed         = 0x0004, /*!< destructor called on this queue */
+            high_watermark = 0x0008, /*!< number of messages reached high watermark
+                                      * (\link mqmx::bounded_message_queue \endlink)
+                                      */
+            low_watermark  = 0x0010  /*!< number of messages fell back to low watermark
+                                      * (\link mqmx::bounded_message_queue \endlink)
+                                      */
         };
 
         /**
@@ -71,7 +84,7 @@ namespace mqmx
 	 * with \link mqmx::message_queue::notification_flag::closed \endlink
          * notification.
          */
-        ~message_queue ();
+        virtual ~message_queue ();
 
         /**
          * \brief Move constructor.
@@ -112,14 +125,85 @@ namespace mqmx
          *                                      to this message queue (has different QID) or
          *                                      message queue was moved out
          */
-        status_code push (message::upointer_type &&);
+        virtual status_code push (message::upointer_type &&);
 
         /**
          * \brief Remove and return message from the top of the queue.
          *
          * \returns Pointer to the message or nullptr if queue is empty or moved out.
          */
-        message::upointer_type pop ();
+        virtual message::upointer_type pop ();
+
+        /**
+         * \brief Push a batch of messages to the end of the queue.
+         *
+         * All messages are moved into the queue as a whole, so at most one
+         * \link mqmx::message_queue::notification_flag::data \endlink notification
+         * is delivered for the whole batch (again only if before this call message
+         * queue was empty).
+         *
+         * \param batch is a container with messages, which is emptied in case of
+         *        success and left intact otherwise
+         *
+         * \retval ExitStatus::Success          if operation completed successfully
+         * \retval ExitStatus::InvalidArgument  if any message in the batch is a nullptr
+         * \retval ExitStatus::NotSupported     if any message doesn't belong to this
+         *                                      message queue (has different QID) or
+         *                                      message queue was moved out
+         */
+        virtual status_code push_batch (container_type & batch);
+
+        /**
+         * \brief Push a range of messages to the end of the queue.
+         *
+         * Convenience wrapper for the container based version. Messages are moved
+         * out of the range [first, last) only in case of success.
+         *
+         * \returns The same set of status codes that could be returned from the
+         *          container based version of this method
+         */
+        template <typename ForwardIt>
+        status_code push_batch (ForwardIt first, ForwardIt last)
+        {
+            container_type batch (std::make_move_iterator (first),
+                                  std::make_move_iterator (last));
+            const status_code retCode = push_batch (batch);
+            if (retCode != ExitStatus::Success)
+            {
+                std::move (std::begin (batch), std::end (batch), first);
+            }
+            return retCode;
+        }
+
+        /**
+         * \brief Remove a number of messages from the top of the queue.
+         *
+         * Moves up to the given number of messages to the end of the given
+         * container at once.
+         *
+         * \param out is a container, which receives messages
+         * \param max is the maximum number of messages to be removed
+         *
+         * \returns The number of removed messages (zero if queue is empty
+         *          or moved out)
+         */
+        virtual size_t drain (container_type & out, const size_t max = static_cast<size_t> (-1));
+
+        /**
+         * \brief Get the maximum number of messages, which consumer should
+         *        drain at once.
+         *
+         * Consumers like \link mqmx::message_queue_pool \endlink don't take
+         * more messages out of the queue ahead of handling.
+         *
+         * \returns static_cast<size_t> (-1) (no limit) by default
+         */
+        virtual size_t get_drain_limit () const;
+
+        /**
+         * \brief Remove and return all messages of the queue.
+         */
+        container_type pop_all ();
 
         /**
          * \brief Create a message for this particular queue.
@@ -162,17 +246,35 @@ namespace mqmx
          * \retval ExitStatus::Success       if operation completed successfully
          * \retval ExitStatus::AlreadyExist  if listener is already set
          */
-        status_code set_listener (listener &);
+        virtual status_code set_listener (listener &);
 
         /**
          * \brief Removes listener.
          */
         void clear_listener ();
 
+        /**
+         * \brief Sets statistics, which is updated by this message queue.
+         *
+         * Statistics object is not owned by the queue, nullptr stops
+         * updating of statistics.
+         *
+         * \attention Should be called before the queue is shared between threads.
+         */
+        void set_stats (queue_stats * stats);
+
+        /**
+         * \brief Get statistics of this message queue (or nullptr).
+         */
+        queue_stats * get_stats () const;
+
+    protected:
+        queue_id_type  _id;       ///< ID of this message queue
+        mutex_type     _mutex;    ///< protects container and listener
+        listener *     _listener; ///< listener (observer) or nullptr
+        queue_stats *  _stats;    ///< statistics or nullptr
+
     private:
-        queue_id_type  _id;
-        mutex_type     _mutex;
         container_type _queue;
-        listener *     _listener;
     };
 } /* namespace mqmx */
@@ -1,12 +1,28 @@
 #include <mqmx/message_queue_poll.h>
 
+#include <algorithm>
+#include <utility>
+
 namespace mqmx
 {
-    message_queue_poll_listener::message_queue_poll_listener ()
-        : _mutex ()
+    const queue_id_type message_queue_poll_listener::MAX_INDEXED_QID = 1 << 20;
+
+    message_queue_poll_listener::message_queue_poll_listener (const listener_mode mode,
+                                                              const queue_id_type qid_hint)
+        : _mode (mode)
+        , _mutex ()
         , _condition ()
         , _notifications ()
+        , _index ()
+        , _priorities ()
+        , _next_qid (0)
     {
+        if (_mode != sorted_list)
+        {
+            const queue_id_type max_qid = std::min (qid_hint, MAX_INDEXED_QID);
+            _index.resize (max_qid + 1, 0);
+            _notifications.reserve (max_qid + 1);
+        }
     }
 
     message_queue_poll_listener::~message_queue_poll_listener ()
@@ -20,6 +36,40 @@ namespace mqmx
         try
         {
             lock_type guard (_mutex);
+            if (_mode != sorted_list)
+            {
+                /* queues with huge IDs (like undefined one) are not indexed */
+                size_t * pos = nullptr;
+                if (qid <= MAX_INDEXED_QID)
+                {
+                    if (_index.size () <= qid)
+                    {
+                        _index.resize (qid + 1, 0);
+                    }
+
+                    pos = &_index[qid];
+                    if (*pos)
+                    {
+                        /* queue already has some notification(s) */
+                        _notifications[*pos - 1].get_flags () |= flag;
+                        return;
+                    }
+                }
+
+                _notifications.emplace_back (qid, mq, flag);
+                if (pos)
+                {
+                    *pos = _notifications.size ();
+                }
+                if (_notifications.size () == 1)
+                {
+                    /* waiter is interested in the first notification only */
+                    notifications_pending ();
+                    _condition.notify_one ();
+                }
+                return;
+            }
+
             const notification_rec_type elem (qid, mq, flag);
             auto iter = std::upper_bound (
                 _notifications.begin (), _notifications.end (), elem);
@@ -34,9 +84,88 @@ namespace mqmx
                 }
             }
             _notifications.insert (iter, elem);
+            if (_notifications.size () == 1)
+            {
+                notifications_pending ();
+            }
             _condition.notify_one ();
         }
         catch (...)
         { }
     }
+
+    void message_queue_poll_listener::clear_index (const notifications_list_type & mqlist)
+    {
+        if (_mode != sorted_list)
+        {
+            for (const auto & rec : mqlist)
+            {
+                if (rec.get_qid () <= MAX_INDEXED_QID)
+                {
+                    _index[rec.get_qid ()] = 0;
+                }
+            }
+        }
+    }
+
+    void message_queue_poll_listener::arrange (notifications_list_type & mqlist) const
+    {
+        if (_mode == priority_list)
+        {
+            /* stable, so queues of the same priority are kept in order of arrival */
+            const auto priority = [this](const notification_rec_type & rec)
+                {
+                    return (rec.get_qid () < _priorities.size ()) ? _priorities[rec.get_qid ()] : 0;
+                };
+            std::stable_sort (std::begin (mqlist), std::end (mqlist),
+                              [&priority](const notification_rec_type & a,
+                                          const notification_rec_type & b)
+                              {
+                                  return priority (b) < priority (a);
+                              });
+        }
+        else if (_mode == round_robin_list)
+        {
+            /* IDs starting from the rotation point go first, the rest follow */
+            const queue_id_type next = _next_qid;
+            std::sort (std::begin (mqlist), std::end (mqlist),
+                       [next](const notification_rec_type & a,
+                              const notification_rec_type & b)
+                       {
+                           return std::make_pair (a.get_qid () < next, a.get_qid ()) <
+                               std::make_pair (b.get_qid () < next, b.get_qid ());
+                       });
+        }
+    }
+
+    void message_queue_poll_listener::rotate (const notifications_list_type & mqlist)
+    {
+        if ((_mode == round_robin_list) && !mqlist.empty ())
+        {
+            _next_qid = mqlist.front ().get_qid () + 1;
+        }
+    }
+
+    void message_queue_poll_listener::set_priority (const queue_id_type qid,
+                                                    const priority_type priority)
+    {
+        if (MAX_INDEXED_QID < qid)
+        {
+            return;
+        }
+
+        lock_type guard (_mutex);
+        if (_priorities.size () <= qid)
+        {
+            _priorities.resize (qid + 1, 0);
+        }
+        _priorities[qid] = priority;
+    }
+
+    message_queue_poll_listener::priority_type
+    message_queue_poll_listener::get_priority (const queue_id_type qid) const
+    {
+        lock_type guard (_mutex);
+        return (qid < _priorities.size ()) ? _priorities[qid] : 0;
+    }
 } /* namespace mqmx */
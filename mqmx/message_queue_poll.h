@@ -18,9 +18,26 @@ namespace mqmx
      * \brief Listener for polling state of multiple message queues.
      *
      * Special listener for polling notifications from multiple message queues.
-     * Stores all notifications as a list (vector) in ascending order of message
-     * queue ID, so record about notifications from message queue with the
-     * smallest ID will be first in the list.
+     * By default stores all notifications as a list (vector) in ascending order
+     * of message queue ID, so record about notifications from message queue with
+     * the smallest ID will be first in the list.
+     *
+     * Alternatively (\link mqmx::message_queue_poll_listener::ready_list \endlink
+     * mode) notifications are kept in order of arrival and located by an index
+     * addressed by message queue ID, so each notification costs O(1). Since
+     * only the first notification of a non-empty queue is reported, queue
+     * with the oldest pending message goes first. This mode is intended for
+     * dense message queue IDs (e.g. assigned by the
+     * \link mqmx::message_queue_pool \endlink), since index grows up to the
+     * biggest notified ID.
+     *
+     * Notifications could be also ordered by explicit priority of message
+     * queue (\link mqmx::message_queue_poll_listener::priority_list \endlink)
+     * or by message queue ID rotated on each take, so every queue gets its
+     * turn to be the first one
+     * (\link mqmx::message_queue_poll_listener::round_robin_list \endlink).
+     * These modes store notifications the same way as ready_list mode does
+     * and order the list when it's got or taken out of the listener.
      *
      * This class doesn't poll message queues directly, but polling is done
      * when this listener is set for some message queue.
@@ -97,34 +114,144 @@ namespace mqmx
         };
 
         typedef std::vector<notification_rec_type> notifications_list_type;
+        typedef int                                 priority_type;
+
+        enum listener_mode
+        {
+            sorted_list      = 0, /*!< notifications are sorted by message queue ID */
+            ready_list       = 1, /*!< notifications are kept in order of arrival */
+            priority_list    = 2, /*!< notifications are sorted by priority of message queue */
+            round_robin_list = 3  /*!< notifications are sorted by rotated message queue ID */
+        };
+
+        /**
+         * \brief Message queues with bigger IDs are not indexed.
+         *
+         * Notifications from such queues (like the ones with
+         * \link mqmx::message::undefined_qid \endlink) are not merged, they
+         * are appended to the list in order of arrival, and their priority
+         * is always zero.
+         */
+        static const queue_id_type MAX_INDEXED_QID;
 
     private:
+        typedef std::vector<size_t>        index_type;
+        typedef std::vector<priority_type> priorities_type;
+
+        const listener_mode     _mode;
         mutable mutex_type      _mutex;
         condvar_type            _condition;
         notifications_list_type _notifications;
+        index_type              _index;      /* qid -> position in the list + 1 (all but sorted_list mode) */
+        priorities_type         _priorities; /* qid -> priority (priority_list mode) */
+        queue_id_type           _next_qid;   /* the first qid of the next take (round_robin_list mode) */
+
+        void clear_index (const notifications_list_type &);
+        void arrange (notifications_list_type &) const;
+        void rotate (const notifications_list_type &);
 
         virtual void notify (const queue_id_type,
                              message_queue *,
                              const message_queue::notification_flags_type) override;
 
+    protected:
+        /**
+         * \brief Called when the first notification is put into the empty list.
+         *
+         * \attention Method is called with mutex of this listener acquired.
+         */
+        virtual void notifications_pending () { }
+
+        /**
+         * \brief Called when non-empty list of notifications is taken out.
+         *
+         * \attention Method is called with mutex of this listener acquired.
+         */
+        virtual void notifications_taken () { }
+
     public:
         /**
-         * \brief Default constructor.
+         * \brief Constructor.
+         *
+         * \param mode defines the way notifications are stored
+         * \param qid_hint is the expected biggest message queue ID (in
+         *        \link mqmx::message_queue_poll_listener::ready_list \endlink mode
+         *        index is preallocated for it)
          */
-        message_queue_poll_listener ();
+        explicit message_queue_poll_listener (const listener_mode mode = sorted_list,
+                                              const queue_id_type qid_hint = 0);
 
         /**
          * \brief Destructor.
          */
         virtual ~message_queue_poll_listener ();
 
+        /**
+         * \brief Get the mode of this listener.
+         */
+        listener_mode get_mode () const
+        {
+            return _mode;
+        }
+
+        /**
+         * \brief Set priority of message queue.
+         *
+         * Notifications from message queues with bigger priority go first
+         * (\link mqmx::message_queue_poll_listener::priority_list \endlink
+         * mode), notifications from queues of the same priority are kept in
+         * order of arrival. Default priority is zero.
+         *
+         * \note Call is ignored for queues with IDs bigger than
+         *       \link mqmx::message_queue_poll_listener::MAX_INDEXED_QID \endlink.
+         */
+        void set_priority (const queue_id_type qid, const priority_type priority);
+
+        /**
+         * \brief Get priority of message queue.
+         */
+        priority_type get_priority (const queue_id_type qid) const;
+
         /**
          * \brief Get the list of notifications.
          */
         notifications_list_type get_notifications () const
         {
             lock_type guard (_mutex);
-            return _notifications;
+            notifications_list_type mqlist (_notifications);
+            arrange (mqlist);
+            return mqlist;
+        }
+
+        /**
+         * \brief Take the list of notifications out of the listener (without waiting).
+         *
+         * \see \link mqmx::message_queue_poll_listener::wait_and_take_notifications \endlink
+         */
+        void take_notifications (notifications_list_type & out)
+        {
+            out.clear ();
+            lock_type guard (_mutex);
+            _notifications.swap (out);
+            clear_index (out);
+            if (!out.empty ())
+            {
+                arrange (out);
+                rotate (out);
+                notifications_taken ();
+            }
+        }
+
+        /**
+         * \brief Sort the list of notifications by message queue ID.
+         *
+         * Could be used for lists taken in
+         * \link mqmx::message_queue_poll_listener::ready_list \endlink mode
+         * when ordering is required.
+         */
+        static void sort_by_qid (notifications_list_type & mqlist)
+        {
+            std::sort (std::begin (mqlist), std::end (mqlist));
         }
 
         /**
@@ -138,6 +265,47 @@ namespace mqmx
                                                         const reference_clock_provider & rcp)
         {
             lock_type guard (_mutex);
+            wait (guard, wtp, rcp);
+            notifications_list_type mqlist (_notifications);
+            arrange (mqlist);
+            return mqlist;
+        }
+
+        /**
+         * \brief Wait for notifications and take them out of the listener.
+         *
+         * Same as \link mqmx::message_queue_poll_listener::wait_for_notifications \endlink,
+         * but the list of notifications is swapped with the given one (which
+         * is cleared beforehand), so the list is not copied and the listener
+         * starts collecting notifications from scratch. This way the listener
+         * could stay set for message queues for a long time.
+         *
+         * \param out receives the list of notifications
+         */
+        template <typename reference_clock_provider>
+        void wait_and_take_notifications (notifications_list_type & out,
+                                          const wait_time_provider & wtp,
+                                          const reference_clock_provider & rcp)
+        {
+            out.clear ();
+            lock_type guard (_mutex);
+            wait (guard, wtp, rcp);
+            _notifications.swap (out);
+            clear_index (out);
+            if (!out.empty ())
+            {
+                arrange (out);
+                rotate (out);
+                notifications_taken ();
+            }
+        }
+
+    private:
+        template <typename reference_clock_provider>
+        void wait (lock_type & guard,
+                   const wait_time_provider & wtp,
+                   const reference_clock_provider & rcp)
+        {
             if (_notifications.empty ())
             {
                 const auto pred = [&]{ return !_notifications.empty (); };
@@ -154,7 +322,6 @@ namespace mqmx
                     }
                 }
             }
-            return _notifications;
         }
     };
 
@@ -1,6 +1,8 @@
 #include "mqmx/message_queue_pool.h"
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <deque>
 
 namespace mqmx
 {
@@ -9,6 +11,7 @@ namespace mqmx
     const message_id_type message_queue_pool::POLL_PAUSE_MESSAGE_ID = 0x01;
     const message_id_type message_queue_pool::ADD_QUEUE_MESSAGE_ID = 0x02;
     const message_id_type message_queue_pool::REMOVE_QUEUE_MESSAGE_ID = 0x03;
+    const message_id_type message_queue_pool::WAKE_UP_MESSAGE_ID = 0x04;
 
     struct message_queue_pool::add_queue_message : message
     {
@@ -36,7 +39,105 @@ namespace mqmx
         { }
     };
 
-    status_code message_queue_pool::control_queue_handler (message::upointer_type && msg)
+    /*
+     * State of message queue shared between workers. The queue is handled
+     * by the worker which moved the state from IDLE to RUNNING, so it is never
+     * handled by two workers at once. Notification which arrives while queue
+     * is running moves it to RERUN, so the queue is handled once again later.
+     * Pending messages (drained, but not handled because of handler failure)
+     * are accessed only by the worker handling the queue.
+     */
+    struct message_queue_pool::queue_slot
+    {
+        enum state_type
+        {
+            IDLE,
+            RUNNING,
+            RERUN,
+            REMOVED
+        };
+
+        std::atomic<int>              state;
+        std::atomic<bool>             has_pending;
+        std::atomic<bool>             allocated; /* queue is handed out to the user */
+        message_queue *               mq;
+        message_queue::container_type pending;
+
+        queue_slot ()
+            : state (REMOVED)
+            , has_pending (false)
+            , allocated (false)
+            , mq (nullptr)
+            , pending ()
+        { }
+    };
+
+    struct message_queue_pool::worker_context
+    {
+        typedef std::deque<notification_rec_type> ready_list_type;
+
+        const size_t                  index;
+        message_queue_poll_listener   listener; /* stays set for all owned queues, O(1) notify */
+        message_queue                 mq_control;
+        std::vector<message_queue *>  mqs;      /* owned queues sorted by qid */
+        notifications_list_type       mqlist;   /* notifications being handled */
+        message_queue::container_type batch;    /* messages being handled */
+
+        /* ready queues, which could be stolen by other workers */
+        mutex_type                    ready_mutex;
+        ready_list_type               ready;
+        std::atomic<size_t>           nready;
+        notifications_list_type       retry;    /* queues to be handled once again */
+        bool                          retry_control;
+
+        /* set while worker (probably) sleeps waiting for notifications */
+        std::atomic<bool>             idle;
+        thread_type                   thread;
+
+        worker_context (const size_t ix,
+                        const queue_id_type max_qid,
+                        const queue_order_type order)
+            : index (ix)
+            , listener (order, max_qid)
+            , mq_control (CONTROL_MESSAGE_QUEUE_ID + ix)
+            , mqs ()
+            , mqlist ()
+            , batch ()
+            , ready_mutex ()
+            , ready ()
+            , nready (0)
+            , retry ()
+            , retry_control (false)
+            , idle (false)
+            , thread ()
+        { }
+    };
+
+    message_queue_pool::worker_context & message_queue_pool::get_owner (const queue_id_type qid)
+    {
+        return *_workers[qid % _workers.size ()];
+    }
+
+    void message_queue_pool::attach_queue (worker_context & w, message_queue * mq)
+    {
+        auto it = std::begin (w.mqs);
+        while ((it != std::end (w.mqs)) && ((*it)->get_qid () < mq->get_qid ()))
+        {
+            ++it;
+        }
+        assert ((it == std::end (w.mqs)) || (mq->get_qid () < (*it)->get_qid ()));
+        w.mqs.insert (it, mq);
+
+        queue_slot & slot = _slots[mq->get_qid ()];
+        slot.mq = mq;
+        slot.state.store (queue_slot::IDLE);
+
+        /* notifies listener immediately if queue is not empty */
+        mq->set_listener (w.listener);
+    }
+
+    status_code message_queue_pool::control_queue_handler (worker_context & w,
+                                                           message::upointer_type && msg)
     {
         if (msg->get_mid () == TERMINATE_MESSAGE_ID)
         {
@@ -51,10 +152,7 @@ namespace mqmx
         if (msg->get_mid () == ADD_QUEUE_MESSAGE_ID)
         {
             add_queue_message * aqmsg = static_cast<add_queue_message *> (msg.get ());
-            auto it = std::begin (_mqs);
-            while ((++it != std::end (_mqs)) && ((*it)->get_qid () < aqmsg->mq->get_qid ()));
-            assert ((it == std::end (_mqs)) || (aqmsg->mq->get_qid () < (*it)->get_qid ()));
-            _mqs.insert (it, aqmsg->mq);
+            attach_queue (w, aqmsg->mq);
             aqmsg->sem->post ();
             return ExitStatus::Success;
         }
@@ -62,20 +160,36 @@ namespace mqmx
         if (msg->get_mid () == REMOVE_QUEUE_MESSAGE_ID)
         {
             remove_queue_message * rqmsg = static_cast<remove_queue_message *> (msg.get ());
-            auto it = std::find (std::begin (_mqs), std::end (_mqs), rqmsg->mq);
-            if (it != std::end (_mqs))
+            auto it = std::find (std::begin (w.mqs), std::end (w.mqs), rqmsg->mq);
+            if (it != std::end (w.mqs))
             {
-                _mqs.erase (it);
+                queue_slot & slot = _slots[(*it)->get_qid ()];
+                (*it)->clear_listener ();
+                w.mqs.erase (it);
+
+                /*
+                 * Queue could be handled by another worker right now. Records
+                 * about removed queue still kept in ready lists are skipped.
+                 */
+                int expected = queue_slot::IDLE;
+                while (!slot.state.compare_exchange_weak (expected, queue_slot::REMOVED))
+                {
+                    expected = queue_slot::IDLE;
+                    std::this_thread::yield ();
+                }
+                slot.mq = nullptr;
+                slot.pending.clear ();
+                slot.has_pending.store (false);
             }
             rqmsg->sem->post ();
-            return ExitStatus::RestartNeeded;
+            return ExitStatus::Success;
         }
 
         return ExitStatus::Success;
     }
 
-    status_code message_queue_pool::handle_notifications (
-        const message_queue_poll_listener::notification_rec_type & rec)
+    status_code message_queue_pool::handle_notifications (worker_context & w,
+                                                          const notification_rec_type & rec)
     {
         if (rec.get_flags () & (message_queue::notification_flag::closed|
                                 message_queue::notification_flag::detached))
@@ -87,125 +201,528 @@ namespace mqmx
             assert (rec.get_mq () != nullptr);
             assert (rec.get_qid () < _handler.size ());
 
-            for (message::upointer_type msg = rec.get_mq ()->pop ();
-		 msg; msg = rec.get_mq ()->pop ())
+            /*
+             * Messages are drained in batches (single lock acquisition per batch),
+             * those left unhandled are kept pending until the next iteration.
+             */
+            queue_slot & slot = _slots[rec.get_qid ()];
+            if (slot.has_pending.load ())
             {
-                const status_code retCode = (_handler[rec.get_qid ()])(std::move (msg));
-                if (retCode != ExitStatus::Success)
-                {
-                    /* TODO: print diagnostic message here */
-                    return retCode;
-		}
-	    }
+                w.batch.swap (slot.pending);
+                slot.has_pending.store (false);
+            }
+
+            /* control queues are never limited */
+            const size_t budget = (rec.get_qid () < _workers.size ())
+                ? static_cast<size_t> (-1)
+                : _queue_budget;
+
+            /* messages are taken ahead of handling only as far as queue allows */
+            const size_t drain_limit = std::min (budget, rec.get_mq ()->get_drain_limit ());
+
+            message_dispatcher * const dispatcher = _dispatcher[rec.get_qid ()].get ();
+            const queue_stats::clock_type::time_point start = _stats
+                ? queue_stats::clock_type::now ()
+                : queue_stats::clock_type::time_point ();
+
+            size_t handled = 0;
+            status_code retCode = ExitStatus::Success;
+            while ((retCode == ExitStatus::Success) && (handled < budget) &&
+                   (!w.batch.empty () ||
+                    rec.get_mq ()->drain (w.batch, std::min (budget - handled, drain_limit))))
+            {
+                message::upointer_type msg = std::move (w.batch.front ());
+                w.batch.pop_front ();
+                ++handled;
+
+                retCode = dispatcher
+                    ? dispatcher->dispatch (std::move (msg))
+                    : (_handler[rec.get_qid ()])(std::move (msg));
+            }
+
+            if (_stats)
+            {
+                _stats[rec.get_qid ()].handled (handled, queue_stats::clock_type::now () - start);
+            }
+
+            if (retCode != ExitStatus::Success)
+            {
+                /* TODO: print diagnostic message here */
+                return retCode;
+            }
+
+            if (handled == budget)
+            {
+                /* queue may still have messages - it's revisited after the others */
+                return ExitStatus::RestartNeeded;
+            }
         }
         return ExitStatus::Success;
     }
 
-    void message_queue_pool::thread_loop ()
+    void message_queue_pool::stash_pending (worker_context & w, const queue_id_type qid)
     {
-        for (;;)
+        if (!w.batch.empty ())
         {
-            const auto mqlist = poll (std::begin (_mqs), std::end (_mqs),
-                                      wait_time_provider::WAIT_INFINITELY);
-            size_t starti = 0;
-            if (mqlist.front ().get_qid () == _mq_control.get_qid ())
+            queue_slot & slot = _slots[qid];
+            slot.pending.swap (w.batch);
+            slot.has_pending.store (true);
+        }
+    }
+
+    void message_queue_pool::schedule_retry (worker_context & w, const notification_rec_type & rec)
+    {
+        lock_type guard (w.ready_mutex);
+        w.retry.push_back (rec);
+    }
+
+    void message_queue_pool::merge_retry (worker_context & w, notifications_list_type & mqlist)
+    {
+        /* retried queues go last, duplicated records just find queues empty */
+        lock_type guard (w.ready_mutex);
+        mqlist.insert (std::end (mqlist), std::begin (w.retry), std::end (w.retry));
+        w.retry.clear ();
+    }
+
+    void message_queue_pool::wake_up (worker_context & w)
+    {
+        /* worker is woken up once, it clears the flag by itself as well */
+        if (w.idle.exchange (false))
+        {
+            w.mq_control.enqueue<message> (WAKE_UP_MESSAGE_ID);
+        }
+    }
+
+    void message_queue_pool::publish_ready (worker_context & w,
+                                            notifications_list_type & mqlist,
+                                            const size_t starti)
+    {
+        if (mqlist.size () <= starti)
+        {
+            return;
+        }
+
+        size_t count = 0;
+        {
+            lock_type guard (w.ready_mutex);
+            w.ready.insert (std::end (w.ready),
+                            std::next (std::begin (mqlist), starti), std::end (mqlist));
+            count = w.ready.size ();
+            w.nready.store (count);
+        }
+
+        /* the first ready queue is for this worker, the rest could be stolen */
+        for (size_t ix = 1; (ix < _workers.size ()) && (1 < count); ++ix)
+        {
+            worker_context & other = *_workers[(w.index + ix) % _workers.size ()];
+            if (other.idle.load ())
             {
-                const status_code retCode = handle_notifications (mqlist.front ());
-                if (retCode == ExitStatus::HaltRequested)
+                wake_up (other);
+                --count;
+            }
+        }
+    }
+
+    bool message_queue_pool::take_ready (worker_context & w,
+                                         notification_rec_type & rec,
+                                         const bool front)
+    {
+        if (w.nready.load () == 0)
+        {
+            return false;
+        }
+
+        lock_type guard (w.ready_mutex);
+        while (!w.ready.empty ())
+        {
+            if (front)
+            {
+                rec = w.ready.front ();
+                w.ready.pop_front ();
+            }
+            else
+            {
+                rec = w.ready.back ();
+                w.ready.pop_back ();
+            }
+            w.nready.store (w.ready.size ());
+
+            /*
+             * Running queue is marked to be handled once again and the record
+             * is dropped, records about removed queues are dropped as well.
+             */
+            queue_slot & slot = _slots[rec.get_qid ()];
+            int state = slot.state.load ();
+            for (;;)
+            {
+                if (state == queue_slot::IDLE)
+                {
+                    if (slot.state.compare_exchange_weak (state, queue_slot::RUNNING))
+                    {
+                        /* registry keeps the only valid pointer to the queue */
+                        rec.get_mq () = slot.mq;
+                        return true;
+                    }
+                }
+                else if (state == queue_slot::RUNNING)
+                {
+                    if (slot.state.compare_exchange_weak (state, queue_slot::RERUN))
+                    {
+                        break;
+                    }
+                }
+                else
                 {
                     break;
                 }
+            }
+        }
+        return false;
+    }
+
+    void message_queue_pool::process_ready (worker_context & w, const notification_rec_type & rec)
+    {
+        status_code retCode = ExitStatus::Success;
+        try
+        {
+            retCode = handle_notifications (w, rec);
+        }
+        catch (...)
+        {
+            retCode = ExitStatus::NotAllowed;
+        }
+        stash_pending (w, rec.get_qid ());
+
+        /*
+         * Queue is handled once again at the next iteration if handler failed
+         * or budget of the queue is exhausted (queue may still have messages,
+         * but no more notifications will come) or new notification arrived
+         * while handling.
+         */
+        queue_slot & slot = _slots[rec.get_qid ()];
+        if ((slot.state.exchange (queue_slot::IDLE) == queue_slot::RERUN) ||
+            (retCode != ExitStatus::Success))
+        {
+            worker_context & owner = get_owner (rec.get_qid ());
+            schedule_retry (owner, rec);
+            if (&owner != &w)
+            {
+                wake_up (owner);
+            }
+        }
+    }
+
+    bool message_queue_pool::steal_ready (worker_context & w)
+    {
+        notification_rec_type rec;
+        for (size_t ix = 1; ix < _workers.size (); ++ix)
+        {
+            worker_context & victim = *_workers[(w.index + ix) % _workers.size ()];
+            if (take_ready (victim, rec, false))
+            {
+                process_ready (w, rec);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void message_queue_pool::thread_loop (worker_context & w)
+    {
+        for (;;)
+        {
+            /*
+             * Flag is raised before looking at ready lists of other workers,
+             * so either this worker sees their changes or they see the flag
+             * and wake this worker up.
+             */
+            w.idle.store (true);
+
+            bool has_work = w.retry_control;
+            {
+                lock_type guard (w.ready_mutex);
+                has_work = has_work || !w.retry.empty ();
+            }
+
+            for (size_t ix = 1; !has_work && (ix < _workers.size ()); ++ix)
+            {
+                has_work = (0 < _workers[(w.index + ix) % _workers.size ()]->nready.load ());
+            }
+
+            /* only queues notified since the last iteration are reported */
+            w.listener.wait_and_take_notifications (
+                w.mqlist,
+                has_work
+                ? wait_time_provider ()
+                : wait_time_provider (wait_time_provider::WAIT_INFINITELY),
+                wait_time_provider ());
+            w.idle.store (false);
+            merge_retry (w, w.mqlist);
+
+            /* notifications are in order of the pool, control queue goes first */
+            const auto ctl = std::find_if (std::begin (w.mqlist), std::end (w.mqlist),
+                                           [&w](const notification_rec_type & rec)
+                                           {
+                                               return rec.get_qid () == w.mq_control.get_qid ();
+                                           });
+            const bool has_control = (ctl != std::end (w.mqlist)) || w.retry_control;
+            if (ctl != std::end (w.mqlist))
+            {
+                std::rotate (std::begin (w.mqlist), ctl, std::next (ctl));
+            }
+            else if (w.retry_control)
+            {
+                w.mqlist.emplace (std::begin (w.mqlist), w.mq_control.get_qid (), &w.mq_control,
+                                  message_queue::notification_flag::data);
+            }
 
-                if (retCode == ExitStatus::RestartNeeded)
+            size_t starti = 0;
+            if (has_control)
+            {
+                const status_code retCode = handle_notifications (w, w.mqlist.front ());
+                stash_pending (w, w.mq_control.get_qid ());
+                w.retry_control = (retCode != ExitStatus::Success);
+
+                if (retCode == ExitStatus::HaltRequested)
                 {
-                    continue;
+                    break;
                 }
 
                 if (retCode == ExitStatus::PauseRequested)
                 {
                     _sem_pause.post ();
                     _sem_resume.wait ();
-                    continue;
                 }
 
                 ++starti;
             }
 
-            for (size_t i = starti; i < mqlist.size (); ++i)
+            publish_ready (w, w.mqlist, starti);
+
+            notification_rec_type rec;
+            while (take_ready (w, rec, true))
             {
-                try
-                {
-                    handle_notifications (mqlist[i]);
-                }
-                catch (...)
-                {
-                    /* TODO: consider to add '#pragma omp cancel for' */
-                }
+                process_ready (w, rec);
             }
+
+            steal_ready (w);
         }
     }
 
     bool message_queue_pool::is_poll_idle ()
     {
-        _mq_control.enqueue<message> (POLL_PAUSE_MESSAGE_ID);
-        _sem_pause.wait ();
+        for (auto & w : _workers)
+        {
+            w->mq_control.enqueue<message> (POLL_PAUSE_MESSAGE_ID);
+        }
 
-        const bool idleStatus = poll (std::begin (_mqs), std::end (_mqs)).empty ();
+        for (size_t ix = 0; ix < _workers.size (); ++ix)
+        {
+            _sem_pause.wait ();
+        }
 
-        _sem_resume.post ();
+        /*
+         * Persistent listeners are replaced by polling for the time of the
+         * check, control queues (the first in each list) are not checked as
+         * they may keep wake up messages.
+         */
+        bool idleStatus = true;
+        for (auto & w : _workers)
+        {
+            const auto first = std::next (std::begin (w->mqs));
+            std::for_each (first, std::end (w->mqs),
+                           [](message_queue * mq) { mq->clear_listener (); });
+
+            idleStatus = idleStatus &&
+                poll (first, std::end (w->mqs)).empty () &&
+                (w->nready.load () == 0);
+            for (auto it = first; it != std::end (w->mqs); ++it)
+            {
+                idleStatus = idleStatus && !_slots[(*it)->get_qid ()].has_pending.load ();
+                (*it)->set_listener (w->listener);
+            }
+        }
+
+        for (size_t ix = 0; ix < _workers.size (); ++ix)
+        {
+            _sem_resume.post ();
+        }
         return idleStatus;
     }
 
-    message_queue_pool::message_queue_pool (const size_t capacity)
-        : _mq_control (CONTROL_MESSAGE_QUEUE_ID)
+    message_queue_pool::message_queue_pool (const size_t capacity,
+                                            const size_t nworkers,
+                                            const size_t queue_budget,
+                                            const queue_order_type queue_order,
+                                            const bool collect_stats)
+        : _queue_budget ((queue_budget == 0) ? static_cast<size_t> (-1) : queue_budget)
+        , _queue_order (queue_order)
         , _handler ()
-        , _mqs ()
+        , _dispatcher ()
+        , _slots ()
+        , _stats ()
+        , _workers ()
         , _sem_pause ()
         , _sem_resume ()
-        , _worker ()
     {
-        _handler.resize (capacity + 1);
-        _handler[_mq_control.get_qid ()] = std::bind (
-            &message_queue_pool::control_queue_handler, this, std::placeholders::_1);
+        const size_t count = std::max (nworkers, static_cast<size_t> (1));
+        _handler.resize (capacity + count);
+        _dispatcher.resize (capacity + count);
+        _slots.reset (new queue_slot[capacity + count]);
+        if (collect_stats)
+        {
+            _stats.reset (new queue_stats[capacity + count]);
+        }
 
-        _mqs.reserve (capacity + 1);
-        _mqs.emplace_back (&_mq_control);
+        _workers.reserve (count);
+        for (size_t ix = 0; ix < count; ++ix)
+        {
+            _workers.emplace_back (new worker_context (ix, capacity + count - 1, _queue_order));
+            worker_context & w = *_workers.back ();
+            _handler[w.mq_control.get_qid ()] = std::bind (
+                &message_queue_pool::control_queue_handler, this,
+                std::ref (w), std::placeholders::_1);
+
+            w.mqs.reserve (capacity / count + 2);
+            attach_queue (w, &w.mq_control);
+        }
 
-        thread_type auxiliary_thread ([this]{ thread_loop (); });
-        _worker.swap (auxiliary_thread);
+        for (auto & w : _workers)
+        {
+            worker_context * pw = w.get ();
+            thread_type auxiliary_thread ([this, pw]{ thread_loop (*pw); });
+            pw->thread.swap (auxiliary_thread);
+        }
     }
 
     message_queue_pool::~message_queue_pool ()
     {
-        _mq_control.enqueue<message> (TERMINATE_MESSAGE_ID);
-        _worker.join ();
+        for (auto & w : _workers)
+        {
+            w->mq_control.enqueue<message> (TERMINATE_MESSAGE_ID);
+        }
+
+        for (auto & w : _workers)
+        {
+            w->thread.join ();
+        }
+
+        /* listeners are destroyed along with workers */
+        for (auto & w : _workers)
+        {
+            std::for_each (std::begin (w->mqs), std::end (w->mqs),
+                           [](message_queue * mq) { mq->clear_listener (); });
+        }
+    }
+
+    size_t message_queue_pool::get_workers_count () const
+    {
+        return _workers.size ();
     }
 
-    message_queue_pool::mq_upointer_type message_queue_pool::allocate_queue (
-        const message_handler_func_type & handler)
+    size_t message_queue_pool::get_queue_budget () const
     {
-        if (!handler)
+        return (_queue_budget == static_cast<size_t> (-1)) ? 0 : _queue_budget;
+    }
+
+    message_queue_pool::queue_order_type message_queue_pool::get_queue_order () const
+    {
+        return _queue_order;
+    }
+
+    status_code message_queue_pool::set_queue_priority (const message_queue * const mq,
+                                                        const priority_type priority)
+    {
+        if (mq == nullptr)
         {
-            return mq_upointer_type ();
+            return ExitStatus::InvalidArgument;
         }
 
-        auto it = std::begin (_handler);
+        if (!(mq->get_qid () < _handler.size ()) || !_handler[mq->get_qid ()])
+        {
+            return ExitStatus::NotFound;
+        }
+
+        get_owner (mq->get_qid ()).listener.set_priority (mq->get_qid (), priority);
+        return ExitStatus::Success;
+    }
+
+    message_queue_pool::stats_list_type message_queue_pool::get_stats () const
+    {
+        stats_list_type result;
+        if (_stats)
+        {
+            /* control queues are not reported */
+            for (queue_id_type qid = _workers.size (); qid < _handler.size (); ++qid)
+            {
+                if (_slots[qid].allocated.load ())
+                {
+                    result.push_back (_stats[qid].get_snapshot (qid));
+                }
+            }
+        }
+        return result;
+    }
+
+    queue_id_type message_queue_pool::reserve_queue_id (
+        const message_handler_func_type & handler)
+    {
+        /* the first IDs are reserved for control queues of workers */
+        auto it = std::next (std::begin (_handler), _workers.size () - 1);
         while ((++it != std::end (_handler)) && *it);
         const queue_id_type qid = std::distance (std::begin (_handler), it);
         assert (qid < _handler.size ());
 
-        mq_upointer_type mq (new message_queue (qid), mq_deleter (this));
         _handler[qid] = handler;
+        return qid;
+    }
+
+    queue_id_type message_queue_pool::reserve_queue_id (const message_dispatcher & dispatcher)
+    {
+        /* handler marks ID as used, yet workers call dispatcher directly */
+        std::shared_ptr<message_dispatcher> copy =
+            std::make_shared<message_dispatcher> (dispatcher);
+        const queue_id_type qid = reserve_queue_id (
+            [copy](message::upointer_type && msg)
+            {
+                return copy->dispatch (std::move (msg));
+            });
+        _dispatcher[qid] = std::move (copy);
+        return qid;
+    }
+
+    message_queue_pool::mq_upointer_type message_queue_pool::register_queue (
+        mq_upointer_type && mq)
+    {
+        if (_stats)
+        {
+            /* queue is not shared yet */
+            mq->set_stats (&_stats[mq->get_qid ()]);
+        }
 
         semaphore_type sem;
-        if (_mq_control.enqueue<add_queue_message> (mq.get (), &sem) == ExitStatus::Success)
+        message_queue & mq_control = get_owner (mq->get_qid ()).mq_control;
+        if (mq_control.enqueue<add_queue_message> (mq.get (), &sem) == ExitStatus::Success)
         {
             sem.wait ();
-            return mq;
+            _slots[mq->get_qid ()].allocated.store (true);
+            return std::move (mq);
         }
         return mq_upointer_type ();
     }
 
+    message_queue_pool::mq_upointer_type message_queue_pool::allocate_queue (
+        const message_handler_func_type & handler)
+    {
+        return allocate_queue<message_queue> (handler);
+    }
+
+    message_queue_pool::mq_upointer_type message_queue_pool::allocate_queue (
+        const message_dispatcher & dispatcher)
+    {
+        return allocate_queue<message_queue> (dispatcher);
+    }
+
     status_code message_queue_pool::remove_queue (const message_queue * const mq)
     {
         if (mq == nullptr)
@@ -219,9 +736,11 @@ namespace mqmx
         }
 
         semaphore_type sem;
-        _mq_control.enqueue<remove_queue_message> (mq, &sem);
+        get_owner (mq->get_qid ()).mq_control.enqueue<remove_queue_message> (mq, &sem);
         sem.wait ();
 
+        /* IDs are never reused, so statistics of the queue are no longer reported */
+        _slots[mq->get_qid ()].allocated.store (false);
         return ExitStatus::Success;
     }
 } /* namespace mqmx */
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <mqmx/libexport.h>
+#include <mqmx/message_dispatcher.h>
 #include <mqmx/message_queue_poll.h>
 
 #include <crs/mutex.h>
@@ -8,11 +9,36 @@
 #include <crs/semaphore.h>
 
 #include <functional>
+#include <memory>
 #include <vector>
 #include <thread>
 
 namespace mqmx
 {
+    /**
+     * \brief Pool of message queues served by a number of worker threads.
+     *
+     * Each message queue allocated from the pool has its own handler, which
+     * is called for each message pushed to the queue. Queues are distributed
+     * across worker threads, each worker keeps a single listener set for all
+     * its queues, so only notified queues are visited on wakeup. Idle workers
+     * steal ready queues from busy ones. Messages of a single queue
+     * are always handled in FIFO order and never by two workers at once.
+     *
+     * Number of messages handled from a queue per turn might be limited, so
+     * a queue with steady producer doesn't starve other queues. Queue, which
+     * exhausted its budget, is revisited after other ready queues are served
+     * (round-robin).
+     *
+     * Queues notified at once are handled in order of arrival of their first
+     * notification (oldest pending message first) by default, order might be
+     * changed to explicit priority of queues or round-robin rotation of IDs.
+     * \see \link mqmx::message_queue_poll_listener::listener_mode \endlink
+     *
+     * Optionally pool keeps statistics of each allocated queue (including
+     * throughput of its handler).
+     * \see \link mqmx::message_queue_pool::get_stats \endlink
+     */
     class MQMX_EXPORT message_queue_pool
     {
     public:
@@ -46,9 +72,13 @@ namespace mqmx
         typedef crs::condvar_type                                     condvar_type;
         typedef crs::semaphore                                        semaphore_type;
         typedef std::unique_ptr<message_queue, mq_deleter>            mq_upointer_type;
+        typedef message_queue_poll_listener::listener_mode            queue_order_type;
+        typedef message_queue_poll_listener::priority_type            priority_type;
+        typedef std::vector<queue_stats::snapshot_type>               stats_list_type;
 
     private:
         typedef std::vector<message_handler_func_type>                handlers_map_type;
+        typedef std::vector<std::shared_ptr<message_dispatcher>>      dispatchers_map_type;
         typedef std::thread                                           thread_type;
 
         struct MQMX_PRIVATE add_queue_message;
@@ -57,31 +87,173 @@ namespace mqmx
         struct MQMX_PRIVATE remove_queue_message;
         friend struct remove_queue_message;
 
+        struct MQMX_PRIVATE queue_slot;
+        struct MQMX_PRIVATE worker_context;
+
         static MQMX_PRIVATE const queue_id_type   CONTROL_MESSAGE_QUEUE_ID;
         static MQMX_PRIVATE const message_id_type TERMINATE_MESSAGE_ID;
         static MQMX_PRIVATE const message_id_type POLL_PAUSE_MESSAGE_ID;
         static MQMX_PRIVATE const message_id_type ADD_QUEUE_MESSAGE_ID;
         static MQMX_PRIVATE const message_id_type REMOVE_QUEUE_MESSAGE_ID;
+        static MQMX_PRIVATE const message_id_type WAKE_UP_MESSAGE_ID;
+
+        typedef message_queue_poll_listener::notification_rec_type   notification_rec_type;
+        typedef message_queue_poll_listener::notifications_list_type notifications_list_type;
+        typedef std::vector<std::unique_ptr<worker_context>>         workers_list_type;
 
-        message_queue                _mq_control;
-        handlers_map_type            _handler;
-        std::vector<message_queue *> _mqs;
-        semaphore_type               _sem_pause;
-        semaphore_type               _sem_resume;
-        thread_type                  _worker;
+        const size_t                  _queue_budget; /* messages per turn */
+        const queue_order_type        _queue_order;
+        handlers_map_type             _handler;
+        dispatchers_map_type          _dispatcher; /* called directly instead of handler (if set) */
+        std::unique_ptr<queue_slot[]> _slots;   /* per queue state, indexed by qid */
+        std::unique_ptr<queue_stats[]> _stats;  /* per queue statistics (if collected), indexed by qid */
+        workers_list_type             _workers; /* worker i owns control queue with qid i */
+        semaphore_type                _sem_pause;
+        semaphore_type                _sem_resume;
 
         status_code remove_queue (const message_queue * const);
-        MQMX_PRIVATE status_code control_queue_handler (message::upointer_type &&);
-        MQMX_PRIVATE status_code handle_notifications (
-            const message_queue_poll_listener::notification_rec_type &);
-        MQMX_PRIVATE void thread_loop ();
+        queue_id_type reserve_queue_id (const message_handler_func_type &);
+        queue_id_type reserve_queue_id (const message_dispatcher &);
+        mq_upointer_type register_queue (mq_upointer_type &&);
+        MQMX_PRIVATE worker_context & get_owner (const queue_id_type);
+        MQMX_PRIVATE status_code control_queue_handler (worker_context &, message::upointer_type &&);
+        MQMX_PRIVATE status_code handle_notifications (worker_context &, const notification_rec_type &);
+        MQMX_PRIVATE void attach_queue (worker_context &, message_queue *);
+        MQMX_PRIVATE void stash_pending (worker_context &, const queue_id_type);
+        MQMX_PRIVATE void schedule_retry (worker_context &, const notification_rec_type &);
+        MQMX_PRIVATE void merge_retry (worker_context &, notifications_list_type &);
+        MQMX_PRIVATE void publish_ready (worker_context &, notifications_list_type &, const size_t);
+        MQMX_PRIVATE bool take_ready (worker_context &, notification_rec_type &, const bool);
+        MQMX_PRIVATE void process_ready (worker_context &, const notification_rec_type &);
+        MQMX_PRIVATE bool steal_ready (worker_context &);
+        MQMX_PRIVATE void wake_up (worker_context &);
+        MQMX_PRIVATE void thread_loop (worker_context &);
 
     public:
-        explicit message_queue_pool (const size_t capacity = 15);
+        /**
+         * \brief Constructor.
+         *
+         * \param capacity is the maximum number of message queues in the pool
+         * \param nworkers is the number of worker threads (at least one)
+         * \param queue_budget is the maximum number of messages handled from
+         *        a queue per turn (zero means no limit)
+         * \param queue_order defines the order ready queues are handled in
+         * \param collect_stats enables statistics of allocated queues
+         */
+        explicit message_queue_pool (const size_t capacity = 15,
+                                     const size_t nworkers = 1,
+                                     const size_t queue_budget = 0,
+                                     const queue_order_type queue_order =
+                                     message_queue_poll_listener::ready_list,
+                                     const bool collect_stats = false);
         ~message_queue_pool ();
 
+        /**
+         * \brief Get the number of worker threads.
+         */
+        size_t get_workers_count () const;
+
+        /**
+         * \brief Get the maximum number of messages handled from a queue per
+         *        turn (zero if not limited).
+         */
+        size_t get_queue_budget () const;
+
+        /**
+         * \brief Get the order ready queues are handled in.
+         */
+        queue_order_type get_queue_order () const;
+
+        /**
+         * \brief Set priority of message queue allocated from this pool.
+         *
+         * Takes effect in \link mqmx::message_queue_poll_listener::priority_list \endlink
+         * order only, queues with bigger priority are handled first.
+         *
+         * \returns ExitStatus::Success on success, ExitStatus::InvalidArgument
+         *          if mq is nullptr, ExitStatus::NotFound if queue doesn't
+         *          belong to this pool
+         */
+        status_code set_queue_priority (const message_queue * const mq,
+                                        const priority_type priority);
+
+        /**
+         * \brief Get snapshots of statistics of all allocated queues.
+         *
+         * \returns List of snapshots in ascending order of message queue ID
+         *          (empty if statistics is not collected)
+         */
+        stats_list_type get_stats () const;
+
+        /**
+         * \brief Check whether all message queues of the pool are empty.
+         *
+         * All workers are paused for the time of the check.
+         */
         bool is_poll_idle ();
 
+        /**
+         * \brief Allocate message queue, which messages are passed to the handler.
+         *
+         * Handler is called by the pool workers for each message of the queue.
+         * Messages of the queue are handled by one worker at a time, so the
+         * handler is never called concurrently for the same queue.
+         */
         mq_upointer_type allocate_queue (const message_handler_func_type &);
+
+        /**
+         * \brief Allocate message queue, which messages are passed to the dispatcher.
+         *
+         * Dispatcher is copied (along with its handlers) and called directly by
+         * the pool (without intermediate handler). Messages of the queue are
+         * handled by one worker at a time, so handlers of the copy are never
+         * called concurrently.
+         */
+        mq_upointer_type allocate_queue (const message_dispatcher &);
+
+        /**
+         * \brief Allocate message queue of some particular type.
+         *
+         * Allows to choose message queue implementation (backend) for each
+         * queue, e.g. \link mqmx::mpsc_message_queue \endlink. Newly created
+         * queue gets its ID as a first constructor's parameter followed by
+         * the rest of parameters of this call.
+         *
+         * \returns Pointer to a newly created message queue or nullptr if
+         *          handler is empty
+         */
+        template <typename queue_type, typename... parameters>
+        mq_upointer_type allocate_queue (const message_handler_func_type & handler,
+                                         parameters&&... args)
+        {
+            static_assert (std::is_convertible<queue_type *, message_queue *>::value,
+                           "Invalid queue_type - should be publicly derived from mqmx::message_queue");
+            if (!handler)
+            {
+                return mq_upointer_type ();
+            }
+
+            const queue_id_type qid = reserve_queue_id (handler);
+            return register_queue (
+                mq_upointer_type (new queue_type (qid, std::forward<parameters> (args)...),
+                                  mq_deleter (this)));
+        }
+
+        /**
+         * \brief Allocate message queue of some particular type with dispatcher.
+         *
+         * \see \link mqmx::message_queue_pool::allocate_queue \endlink
+         */
+        template <typename queue_type, typename... parameters>
+        mq_upointer_type allocate_queue (const message_dispatcher & dispatcher,
+                                         parameters&&... args)
+        {
+            static_assert (std::is_convertible<queue_type *, message_queue *>::value,
+                           "Invalid queue_type - should be publicly derived from mqmx::message_queue");
+            const queue_id_type qid = reserve_queue_id (dispatcher);
+            return register_queue (
+                mq_upointer_type (new queue_type (qid, std::forward<parameters> (args)...),
+                                  mq_deleter (this)));
+        }
     };
 } /* namespace mqmx */
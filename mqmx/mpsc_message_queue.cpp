@@ -0,0 +1,237 @@
+#include <mqmx/mpsc_message_queue.h>
+#include <thread>
+
+namespace mqmx
+{
+    mpsc_message_queue::mpsc_message_queue (const queue_id_type ID)
+        : message_queue (ID)
+        , _stub (message::undefined_qid, 0)
+        , _head (&_stub)
+        , _tail (&_stub)
+        , _size (0)
+    {
+    }
+
+    mpsc_message_queue::~mpsc_message_queue ()
+    {
+        while (pop ());
+    }
+
+    void mpsc_message_queue::link (message * first, message * last)
+    {
+        last->_next.store (nullptr, std::memory_order_relaxed);
+        message * prev = _head.exchange (last, std::memory_order_acq_rel);
+        prev->_next.store (first, std::memory_order_release);
+    }
+
+    void mpsc_message_queue::notify_data ()
+    {
+        lock_type guard (_mutex);
+        if (_listener)
+        {
+            _listener->notify (_id, this, notification_flag::data);
+        }
+    }
+
+    status_code mpsc_message_queue::push (message::upointer_type && msg)
+    {
+        if (msg.get () == nullptr)
+        {
+            return ExitStatus::InvalidArgument;
+        }
+
+        if ((_id == message::undefined_qid) ||
+            (_id != msg->get_qid ()))
+        {
+            return ExitStatus::NotSupported;
+        }
+
+        if (_stats)
+        {
+            _stats->pushed (*msg);
+        }
+
+        message * const pmsg = msg.release ();
+        link (pmsg, pmsg);
+        if (_size.fetch_add (1, std::memory_order_acq_rel) == 0)
+        {
+            /* only first message will be reported */
+            notify_data ();
+        }
+        return ExitStatus::Success;
+    }
+
+    status_code mpsc_message_queue::push_batch (container_type & batch)
+    {
+        for (const auto & msg : batch)
+        {
+            if (msg.get () == nullptr)
+            {
+                return ExitStatus::InvalidArgument;
+            }
+
+            if ((_id == message::undefined_qid) ||
+                (_id != msg->get_qid ()))
+            {
+                return ExitStatus::NotSupported;
+            }
+        }
+
+        if (batch.empty ())
+        {
+            return ExitStatus::Success;
+        }
+
+        if (_stats)
+        {
+            for (const auto & msg : batch)
+            {
+                _stats->pushed (*msg);
+            }
+        }
+
+        /* chain messages before publishing them all at once */
+        message * const first = batch.front ().get ();
+        message * last = first;
+        for (auto it = std::next (std::begin (batch)); it != std::end (batch); ++it)
+        {
+            last->_next.store (it->get (), std::memory_order_relaxed);
+            last = it->get ();
+        }
+
+        const long count = static_cast<long> (batch.size ());
+        for (auto & msg : batch)
+        {
+            msg.release ();
+        }
+        batch.clear ();
+
+        link (first, last);
+        if (_size.fetch_add (count, std::memory_order_acq_rel) == 0)
+        {
+            /* only first message will be reported */
+            notify_data ();
+        }
+        return ExitStatus::Success;
+    }
+
+    message * mpsc_message_queue::try_pop (bool & inconsistent)
+    {
+        /* D. Vyukov's intrusive MPSC node-based queue */
+        inconsistent = false;
+        message * tail = _tail;
+        message * next = tail->_next.load (std::memory_order_acquire);
+        if (tail == &_stub)
+        {
+            if (next == nullptr)
+            {
+                inconsistent = (_head.load (std::memory_order_acquire) != tail);
+                return nullptr;
+            }
+            _tail = tail = next;
+            next = next->_next.load (std::memory_order_acquire);
+        }
+
+        if (next)
+        {
+            _tail = next;
+            return tail;
+        }
+
+        if (tail != _head.load (std::memory_order_acquire))
+        {
+            /* some producer is in the middle of push operation */
+            inconsistent = true;
+            return nullptr;
+        }
+
+        link (&_stub, &_stub);
+        next = tail->_next.load (std::memory_order_acquire);
+        if (next)
+        {
+            _tail = next;
+            return tail;
+        }
+        inconsistent = true;
+        return nullptr;
+    }
+
+    message * mpsc_message_queue::pop_linked ()
+    {
+        bool inconsistent = false;
+        message * msg = try_pop (inconsistent);
+        while (inconsistent)
+        {
+            /*
+             * Some message has already taken its place in the list, but is
+             * not linked yet. Returning nullptr here would break "only first
+             * push notifies" rule, so wait until push operation completes.
+             */
+            std::this_thread::yield ();
+            msg = try_pop (inconsistent);
+        }
+        return msg;
+    }
+
+    message::upointer_type mpsc_message_queue::pop ()
+    {
+        message * msg = pop_linked ();
+        if (msg)
+        {
+            _size.fetch_sub (1, std::memory_order_acq_rel);
+            if (_stats)
+            {
+                _stats->popped (*msg);
+            }
+        }
+        return message::upointer_type (msg);
+    }
+
+    size_t mpsc_message_queue::drain (container_type & out, const size_t max)
+    {
+        size_t count = 0;
+        try
+        {
+            for (; count < max; ++count)
+            {
+                message::upointer_type msg (pop_linked ());
+                if (!msg)
+                {
+                    break;
+                }
+                if (_stats)
+                {
+                    _stats->popped (*msg);
+                }
+                out.push_back (std::move (msg));
+            }
+        }
+        catch (...)
+        {
+            _size.fetch_sub (static_cast<long> (count + 1), std::memory_order_acq_rel);
+            throw;
+        }
+
+        if (count)
+        {
+            _size.fetch_sub (static_cast<long> (count), std::memory_order_acq_rel);
+        }
+        return count;
+    }
+
+    status_code mpsc_message_queue::set_listener (listener & l)
+    {
+        lock_type guard (_mutex);
+        if (_listener)
+        {
+            return ExitStatus::AlreadyExist;
+        }
+
+        _listener = &l;
+        if (0 < _size.load (std::memory_order_acquire))
+        {
+            _listener->notify (_id, this, notification_flag::data);
+        }
+        return ExitStatus::Success;
+    }
+} /* namespace mqmx */
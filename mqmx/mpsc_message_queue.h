@@ -0,0 +1,105 @@
+#pragma once
+
+#include <mqmx/libexport.h>
+#include <mqmx/message_queue.h>
+
+#include <atomic>
+
+namespace mqmx
+{
+    /**
+     * \brief Lock-free multi-producer/single-consumer message queue (FIFO).
+     *
+     * Messages are linked into an intrusive list, so push operation neither
+     * allocates memory nor acquires any mutex. Any number of threads can
+     * push messages concurrently, but only one thread at a time is allowed
+     * to pop them (e.g. worker of \link mqmx::message_queue_pool \endlink).
+     *
+     * Listener semantics are the same as for \link mqmx::message_queue \endlink:
+     * \link mqmx::message_queue::notification_flag::data \endlink notification
+     * is delivered only for the first message pushed to the empty queue. The
+     * mutex inherited from the base class is acquired only for delivering
+     * this notification and for setting (clearing) the listener.
+     *
+     * \note Objects of this class could not be moved.
+     */
+    class MQMX_EXPORT mpsc_message_queue final : public message_queue
+    {
+        mpsc_message_queue (const mpsc_message_queue &) = delete;
+        mpsc_message_queue & operator = (const mpsc_message_queue &) = delete;
+        mpsc_message_queue (mpsc_message_queue &&) = delete;
+        mpsc_message_queue & operator = (mpsc_message_queue &&) = delete;
+
+    public:
+        /**
+         * \brief Default constructor.
+         */
+        mpsc_message_queue (const queue_id_type = message::undefined_qid);
+
+        /**
+         * \brief Destructor.
+         *
+         * Destroys all messages left in the queue.
+         */
+        virtual ~mpsc_message_queue ();
+
+        /**
+         * \brief Push some message to the end of the queue.
+         *
+         * Could be called concurrently from any number of threads.
+         *
+         * \retval ExitStatus::Success          if operation completed successfully
+         * \retval ExitStatus::InvalidArgument  if argument is a nullptr
+         * \retval ExitStatus::NotSupported     if message passed as a parameter doesn't belong
+         *                                      to this message queue (has different QID)
+         */
+        virtual status_code push (message::upointer_type &&) override;
+
+        /**
+         * \brief Remove and return message from the top of the queue.
+         *
+         * \attention Should be called from one thread at a time only.
+         *
+         * \returns Pointer to the message or nullptr if queue is empty.
+         */
+        virtual message::upointer_type pop () override;
+
+        using message_queue::push_batch;
+
+        /**
+         * \brief Push a batch of messages to the end of the queue.
+         *
+         * Whole batch is linked into the queue with a single atomic operation.
+         *
+         * \see \link mqmx::message_queue::push_batch \endlink
+         */
+        virtual status_code push_batch (container_type & batch) override;
+
+        /**
+         * \brief Remove a number of messages from the top of the queue.
+         *
+         * \attention Should be called from one thread at a time only.
+         *
+         * \see \link mqmx::message_queue::drain \endlink
+         */
+        virtual size_t drain (container_type & out, const size_t max = static_cast<size_t> (-1)) override;
+
+        /**
+         * \brief Sets new listener for this message queue.
+         *
+         * \see \link mqmx::message_queue::set_listener \endlink
+         */
+        virtual status_code set_listener (listener &) override;
+
+    private:
+        message *             try_pop (bool & inconsistent);
+        message *             pop_linked ();
+        void                  link (message * first, message * last);
+        void                  notify_data ();
+
+        message               _stub;
+        std::atomic<message*> _head; /* producers side */
+        message *             _tail; /* consumer side */
+        std::atomic<long>     _size; /* pushed minus popped (transiently negative) */
+    };
+} /* namespace mqmx */
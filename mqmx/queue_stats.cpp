@@ -0,0 +1,121 @@
+#include <mqmx/queue_stats.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+namespace mqmx
+{
+    namespace
+    {
+        /* pointer returned by global operator new is kept right before the aligned block */
+        void * allocate_aligned (const size_t size)
+        {
+            char * raw = static_cast<char *> (::operator new (size + cache_line_size));
+            char * ptr = raw + cache_line_size - reinterpret_cast<uintptr_t> (raw) % cache_line_size;
+            reinterpret_cast<char **> (ptr)[-1] = raw;
+            return ptr;
+        }
+
+        void deallocate_aligned (void * ptr) noexcept
+        {
+            if (ptr)
+            {
+                ::operator delete (static_cast<char **> (ptr)[-1]);
+            }
+        }
+    } /* namespace */
+
+    const size_t queue_stats::TIME_BUCKETS;
+
+    queue_stats::queue_stats ()
+        : _producer ()
+        , _consumer ()
+    {
+        reset ();
+    }
+
+    void * queue_stats::operator new (std::size_t size)
+    {
+        return allocate_aligned (size);
+    }
+
+    void * queue_stats::operator new[] (std::size_t size)
+    {
+        return allocate_aligned (size);
+    }
+
+    void queue_stats::operator delete (void * ptr) noexcept
+    {
+        deallocate_aligned (ptr);
+    }
+
+    void queue_stats::operator delete[] (void * ptr) noexcept
+    {
+        deallocate_aligned (ptr);
+    }
+
+    void queue_stats::reset ()
+    {
+        _producer.enqueued.store (0, std::memory_order_relaxed);
+        _consumer.dequeued.store (0, std::memory_order_relaxed);
+        _consumer.max_depth.store (0, std::memory_order_relaxed);
+        _consumer.handled.store (0, std::memory_order_relaxed);
+        _consumer.handler_ns.store (0, std::memory_order_relaxed);
+        for (auto & bucket : _consumer.time_in_queue)
+        {
+            bucket.store (0, std::memory_order_relaxed);
+        }
+    }
+
+    void queue_stats::popped (const size_t count)
+    {
+        const uint64_t dequeued = _consumer.dequeued.fetch_add (count, std::memory_order_relaxed);
+
+        /* depth right before this pop, producers may be ahead, so it's approximate */
+        const uint64_t enqueued = _producer.enqueued.load (std::memory_order_relaxed);
+        const uint64_t depth = (dequeued < enqueued) ? (enqueued - dequeued) : 0;
+        uint64_t max_depth = _consumer.max_depth.load (std::memory_order_relaxed);
+        while ((max_depth < depth) &&
+               !_consumer.max_depth.compare_exchange_weak (max_depth, depth, std::memory_order_relaxed));
+    }
+
+    void queue_stats::handled (const size_t count, const clock_type::duration & elapsed)
+    {
+        _consumer.handled.fetch_add (count, std::memory_order_relaxed);
+        _consumer.handler_ns.fetch_add (
+            static_cast<uint64_t> (
+                std::chrono::duration_cast<std::chrono::nanoseconds> (elapsed).count ()),
+            std::memory_order_relaxed);
+    }
+
+    void queue_stats::account_time (const uint64_t ns)
+    {
+        size_t bucket = 0;
+        for (uint64_t us = ns / 1000; us && (bucket + 1 < TIME_BUCKETS); us >>= 1)
+        {
+            ++bucket;
+        }
+        _consumer.time_in_queue[bucket].fetch_add (1, std::memory_order_relaxed);
+    }
+
+    queue_stats::snapshot_type queue_stats::get_snapshot (const queue_id_type qid) const
+    {
+        snapshot_type result;
+        result.qid = qid;
+        result.dequeued = _consumer.dequeued.load (std::memory_order_relaxed);
+        result.enqueued = _producer.enqueued.load (std::memory_order_relaxed);
+        result.depth = (result.dequeued < result.enqueued) ? (result.enqueued - result.dequeued) : 0;
+
+        /* messages pushed after the last pop are not accounted by consumer yet */
+        result.max_depth = std::max (_consumer.max_depth.load (std::memory_order_relaxed),
+                                     result.depth);
+        result.handled = _consumer.handled.load (std::memory_order_relaxed);
+        result.handler_ns = _consumer.handler_ns.load (std::memory_order_relaxed);
+        for (size_t ix = 0; ix < TIME_BUCKETS; ++ix)
+        {
+            result.time_in_queue[ix] = _consumer.time_in_queue[ix].load (std::memory_order_relaxed);
+        }
+        return result;
+    }
+} /* namespace mqmx */
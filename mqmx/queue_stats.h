@@ -0,0 +1,146 @@
+#pragma once
+
+#include <mqmx/libexport.h>
+#include <mqmx/message.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace mqmx
+{
+    /**
+     * \brief Runtime statistics of message queue.
+     *
+     * Counters are updated with relaxed atomic operations by producers and
+     * consumer of message queue, counters of each side are kept in their own
+     * cache line. Producers only count pushed messages, the high-water mark
+     * is updated by consumer (queue is the deepest right before pop). Time in
+     * queue is measured only for messages pushed while statistics is set for
+     * the queue (push operation stamps the message).
+     *
+     * \see \link mqmx::message_queue::set_stats \endlink
+     */
+    class MQMX_EXPORT queue_stats
+    {
+        queue_stats (const queue_stats &) = delete;
+        queue_stats & operator = (const queue_stats &) = delete;
+
+    public:
+        typedef std::chrono::steady_clock clock_type;
+
+        /**
+         * \brief Number of buckets of time in queue histogram.
+         *
+         * Bucket 0 counts messages, which spent less than a microsecond in
+         * the queue, bucket i counts messages, which spent [2^(i-1), 2^i)
+         * microseconds, the last bucket counts all the rest.
+         */
+        static const size_t TIME_BUCKETS = 24;
+
+        typedef std::array<uint64_t, TIME_BUCKETS> histogram_type;
+
+        /**
+         * \brief Snapshot of statistics.
+         */
+        struct snapshot_type
+        {
+            queue_id_type  qid;           ///< ID of message queue
+            uint64_t       enqueued;      ///< total number of pushed messages
+            uint64_t       dequeued;      ///< total number of popped messages
+            uint64_t       depth;         ///< current number of messages
+            uint64_t       max_depth;     ///< the biggest number of messages (high-water mark)
+            uint64_t       handled;       ///< number of messages handled by pool
+            uint64_t       handler_ns;    ///< time spent by handlers of pool (nanoseconds)
+            histogram_type time_in_queue; ///< time spent by messages in queue
+        };
+
+        queue_stats ();
+
+        /* objects are aligned to cache line even if C++17 aligned new isn't available */
+        static void * operator new (std::size_t size);
+        static void * operator new[] (std::size_t size);
+        static void operator delete (void * ptr) noexcept;
+        static void operator delete[] (void * ptr) noexcept;
+
+        /**
+         * \brief Reset all counters.
+         *
+         * \attention Should not be called concurrently with other methods.
+         */
+        void reset ();
+
+        /**
+         * \brief Account message being pushed (stamps the message).
+         */
+        void pushed (message & msg)
+        {
+            msg._stamp = now ();
+            pushed (1);
+        }
+
+        /**
+         * \brief Account a number of messages being pushed (without stamps).
+         */
+        void pushed (const size_t count)
+        {
+            _producer.enqueued.fetch_add (count, std::memory_order_relaxed);
+        }
+
+        /**
+         * \brief Account message being popped.
+         */
+        void popped (const message & msg)
+        {
+            if (msg._stamp)
+            {
+                account_time (now () - msg._stamp);
+            }
+            popped (1);
+        }
+
+        /**
+         * \brief Account a number of messages being popped (without stamps).
+         */
+        void popped (const size_t count);
+
+        /**
+         * \brief Account messages handled by message queue pool.
+         */
+        void handled (const size_t count, const clock_type::duration & elapsed);
+
+        /**
+         * \brief Get snapshot of statistics.
+         */
+        snapshot_type get_snapshot (const queue_id_type qid) const;
+
+    private:
+        static uint64_t now ()
+        {
+            return static_cast<uint64_t> (std::chrono::duration_cast<std::chrono::nanoseconds> (
+                                              clock_type::now ().time_since_epoch ()).count ());
+        }
+
+        void account_time (const uint64_t ns);
+
+        typedef std::array<std::atomic<uint64_t>, TIME_BUCKETS> atomic_histogram_type;
+
+        struct alignas (cache_line_size) producer_counters
+        {
+            std::atomic<uint64_t> enqueued;
+        };
+
+        struct alignas (cache_line_size) consumer_counters
+        {
+            std::atomic<uint64_t> dequeued;
+            std::atomic<uint64_t> max_depth;
+            std::atomic<uint64_t> handled;
+            std::atomic<uint64_t> handler_ns;
+            atomic_histogram_type time_in_queue;
+        };
+
+        producer_counters _producer;
+        consumer_counters _consumer;
+    };
+} /* namespace mqmx */
@@ -0,0 +1,216 @@
+#include <mqmx/spsc_message_queue.h>
+#include <algorithm>
+
+namespace mqmx
+{
+    namespace
+    {
+        size_t round_up_to_power_of_two (const size_t value)
+        {
+            size_t result = 1;
+            while (result < value)
+            {
+                result <<= 1;
+            }
+            return result;
+        }
+    } /* namespace */
+
+    const size_t spsc_message_queue::DEFAULT_CAPACITY = 1024;
+
+    spsc_message_queue::spsc_message_queue (const queue_id_type ID, const size_t capacity)
+        : message_queue (ID)
+        , _ring (round_up_to_power_of_two (capacity))
+        , _mask (_ring.size () - 1)
+        , _pad0 ()
+        , _tail (0)
+        , _cached_head (0)
+        , _pad1 ()
+        , _head (0)
+        , _cached_tail (0)
+        , _pad2 ()
+    {
+    }
+
+    spsc_message_queue::~spsc_message_queue ()
+    {
+    }
+
+    size_t spsc_message_queue::get_capacity () const
+    {
+        return _ring.size ();
+    }
+
+    status_code spsc_message_queue::push (message::upointer_type && msg)
+    {
+        if (msg.get () == nullptr)
+        {
+            return ExitStatus::InvalidArgument;
+        }
+
+        if ((_id == message::undefined_qid) ||
+            (_id != msg->get_qid ()))
+        {
+            return ExitStatus::NotSupported;
+        }
+
+        const size_t tail = _tail.load (std::memory_order_relaxed);
+        if (tail - _cached_head == _ring.size ())
+        {
+            _cached_head = _head.load (std::memory_order_acquire);
+            if (tail - _cached_head == _ring.size ())
+            {
+                return ExitStatus::Overflow;
+            }
+        }
+
+        if (_stats)
+        {
+            _stats->pushed (*msg);
+        }
+        _ring[tail & _mask] = std::move (msg);
+
+        /*
+         * Both stores of indices and subsequent loads of opposite indices are
+         * sequentially consistent, so either consumer will see this message or
+         * producer will see the queue was empty and deliver notification.
+         */
+        _tail.store (tail + 1, std::memory_order_seq_cst);
+        if (_head.load (std::memory_order_seq_cst) == tail)
+        {
+            /* only first message will be reported */
+            lock_type guard (_mutex);
+            if (_listener)
+            {
+                _listener->notify (_id, this, notification_flag::data);
+            }
+        }
+        return ExitStatus::Success;
+    }
+
+    status_code spsc_message_queue::push_batch (container_type & batch)
+    {
+        for (const auto & msg : batch)
+        {
+            if (msg.get () == nullptr)
+            {
+                return ExitStatus::InvalidArgument;
+            }
+
+            if ((_id == message::undefined_qid) ||
+                (_id != msg->get_qid ()))
+            {
+                return ExitStatus::NotSupported;
+            }
+        }
+
+        if (batch.empty ())
+        {
+            return ExitStatus::Success;
+        }
+
+        const size_t tail = _tail.load (std::memory_order_relaxed);
+        if (_ring.size () - (tail - _cached_head) < batch.size ())
+        {
+            _cached_head = _head.load (std::memory_order_acquire);
+            if (_ring.size () - (tail - _cached_head) < batch.size ())
+            {
+                return ExitStatus::Overflow;
+            }
+        }
+
+        size_t pos = tail;
+        for (auto & msg : batch)
+        {
+            if (_stats)
+            {
+                _stats->pushed (*msg);
+            }
+            _ring[pos++ & _mask] = std::move (msg);
+        }
+        batch.clear ();
+
+        _tail.store (pos, std::memory_order_seq_cst);
+        if (_head.load (std::memory_order_seq_cst) == tail)
+        {
+            /* only first message will be reported */
+            lock_type guard (_mutex);
+            if (_listener)
+            {
+                _listener->notify (_id, this, notification_flag::data);
+            }
+        }
+        return ExitStatus::Success;
+    }
+
+    message::upointer_type spsc_message_queue::pop ()
+    {
+        const size_t head = _head.load (std::memory_order_relaxed);
+        if (head == _cached_tail)
+        {
+            _cached_tail = _tail.load (std::memory_order_seq_cst);
+            if (head == _cached_tail)
+            {
+                return message::upointer_type ();
+            }
+        }
+
+        message::upointer_type msg = std::move (_ring[head & _mask]);
+        _head.store (head + 1, std::memory_order_seq_cst);
+        if (_stats)
+        {
+            _stats->popped (*msg);
+        }
+        return msg;
+    }
+
+    size_t spsc_message_queue::drain (container_type & out, const size_t max)
+    {
+        const size_t head = _head.load (std::memory_order_relaxed);
+        if (_cached_tail - head < max)
+        {
+            _cached_tail = _tail.load (std::memory_order_seq_cst);
+        }
+
+        const size_t count = std::min (max, _cached_tail - head);
+        size_t pos = head;
+        try
+        {
+            for (; pos != head + count; ++pos)
+            {
+                if (_stats)
+                {
+                    _stats->popped (*_ring[pos & _mask]);
+                }
+                out.push_back (std::move (_ring[pos & _mask]));
+            }
+        }
+        catch (...)
+        {
+            _head.store (pos, std::memory_order_seq_cst);
+            throw;
+        }
+
+        if (count)
+        {
+            _head.store (pos, std::memory_order_seq_cst);
+        }
+        return count;
+    }
+
+    status_code spsc_message_queue::set_listener (listener & l)
+    {
+        lock_type guard (_mutex);
+        if (_listener)
+        {
+            return ExitStatus::AlreadyExist;
+        }
+
+        _listener = &l;
+        if (_tail.load (std::memory_order_seq_cst) != _head.load (std::memory_order_seq_cst))
+        {
+            _listener->notify (_id, this, notification_flag::data);
+        }
+        return ExitStatus::Success;
+    }
+} /* namespace mqmx */
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <mqmx/libexport.h>
+#include <mqmx/message_queue.h>
+
+#include <atomic>
+#include <vector>
+
+namespace mqmx
+{
+    /**
+     * \brief Bounded single-producer/single-consumer message queue (FIFO).
+     *
+     * Messages are stored in a ring buffer of fixed capacity, so neither push
+     * nor pop operation allocates memory or acquires any mutex. Both operations
+     * are wait-free. Indices of the producer and the consumer are kept in
+     * separate cache lines.
+     *
+     * Only one thread at a time is allowed to push messages and only one
+     * (probably another) thread at a time is allowed to pop them (e.g. worker
+     * of \link mqmx::message_queue_pool \endlink).
+     *
+     * Listener semantics are the same as for \link mqmx::message_queue \endlink.
+     * The mutex inherited from the base class is acquired only for delivering
+     * \link mqmx::message_queue::notification_flag::data \endlink notification
+     * and for setting (clearing) the listener.
+     *
+     * \note Objects of this class could not be moved.
+     */
+    class MQMX_EXPORT spsc_message_queue final : public message_queue
+    {
+        spsc_message_queue (const spsc_message_queue &) = delete;
+        spsc_message_queue & operator = (const spsc_message_queue &) = delete;
+        spsc_message_queue (spsc_message_queue &&) = delete;
+        spsc_message_queue & operator = (spsc_message_queue &&) = delete;
+
+    public:
+        static const size_t DEFAULT_CAPACITY; ///< default capacity of the queue
+
+        /**
+         * \brief Constructor.
+         *
+         * \param qid is an ID of this message queue
+         * \param capacity is the maximum number of messages in the queue (will be
+         *        rounded up to the nearest power of two)
+         */
+        spsc_message_queue (const queue_id_type qid = message::undefined_qid,
+                            const size_t capacity = DEFAULT_CAPACITY);
+
+        /**
+         * \brief Destructor.
+         */
+        virtual ~spsc_message_queue ();
+
+        /**
+         * \brief Get maximum number of messages in the queue.
+         */
+        size_t get_capacity () const;
+
+        /**
+         * \brief Push some message to the end of the queue.
+         *
+         * \attention Should be called from one thread at a time only.
+         *
+         * \retval ExitStatus::Success          if operation completed successfully
+         * \retval ExitStatus::InvalidArgument  if argument is a nullptr
+         * \retval ExitStatus::NotSupported     if message passed as a parameter doesn't belong
+         *                                      to this message queue (has different QID)
+         * \retval ExitStatus::Overflow         if queue is full (message is not consumed)
+         */
+        virtual status_code push (message::upointer_type &&) override;
+
+        /**
+         * \brief Remove and return message from the top of the queue.
+         *
+         * \attention Should be called from one thread at a time only.
+         *
+         * \returns Pointer to the message or nullptr if queue is empty.
+         */
+        virtual message::upointer_type pop () override;
+
+        using message_queue::push_batch;
+
+        /**
+         * \brief Push a batch of messages to the end of the queue.
+         *
+         * \see \link mqmx::message_queue::push_batch \endlink
+         *
+         * \attention Should be called from one thread at a time only.
+         *
+         * \retval ExitStatus::Overflow if there is no room for the whole batch
+         *                              (none of messages is consumed)
+         */
+        virtual status_code push_batch (container_type & batch) override;
+
+        /**
+         * \brief Remove a number of messages from the top of the queue.
+         *
+         * \attention Should be called from one thread at a time only.
+         *
+         * \see \link mqmx::message_queue::drain \endlink
+         */
+        virtual size_t drain (container_type & out, const size_t max = static_cast<size_t> (-1)) override;
+
+        /**
+         * \brief Sets new listener for this message queue.
+         *
+         * \see \link mqmx::message_queue::set_listener \endlink
+         */
+        virtual status_code set_listener (listener &) override;
+
+    private:
+        typedef std::vector<message::upointer_type> ring_type;
+
+        ring_type           _ring;
+        const size_t        _mask;
+
+        /* producer side */
+        char                _pad0[cache_line_size];
+        std::atomic<size_t> _tail;
+        size_t              _cached_head;
+
+        /* consumer side */
+        char                _pad1[cache_line_size - sizeof (std::atomic<size_t>) - sizeof (size_t)];
+        std::atomic<size_t> _head;
+        size_t              _cached_tail;
+        char                _pad2[cache_line_size - sizeof (std::atomic<size_t>) - sizeof (size_t)];
+    };
+} /* namespace mqmx */
@@ -4,8 +4,10 @@ namespace mqmx
 {
 namespace testing
 {
-    work_queue_for_tests::work_queue_for_tests (const sync_function_type & sync_func)
-        : work_queue (work_queue::dont_start_worker ())
+    work_queue_for_tests::work_queue_for_tests (const sync_function_type & sync_func,
+                                                const work_queue::timer_engine engine,
+                                                const work_queue::duration_type & tick)
+        : work_queue (work_queue::dont_start_worker (), engine, tick)
         , _current_time_point (work_queue::clock_type::now ())
         , _time_forwarding_flag (false)
         , _time_forwarding_completed ()
@@ -61,8 +61,13 @@ namespace testing
     public:
         /**
          * \brief Default constructor.
+         *
+         * \param engine is the engine keeping scheduled works
+         * \param tick is the granularity of the timer wheel
          */
-        work_queue_for_tests (const sync_function_type & = sync_function_type ());
+        work_queue_for_tests (const sync_function_type & = sync_function_type (),
+                              const work_queue::timer_engine engine = work_queue::binary_heap,
+                              const work_queue::duration_type & tick = work_queue::DEFAULT_TICK);
 
         /**
          * \brief Virtual destructor.
@@ -0,0 +1,166 @@
+#include <mqmx/timerfd_work_queue.h>
+
+#if defined(__linux__)
+
+#include <cstdint>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+namespace mqmx
+{
+    timerfd_work_queue::timerfd_work_queue (const work_queue::duration_type & spin,
+                                            const work_queue::timer_engine engine,
+                                            const work_queue::duration_type & tick)
+        : work_queue (work_queue::dont_start_worker (), engine, tick)
+        , _spin ((spin.count () > 0) ? spin : work_queue::duration_type ())
+        , _timer_fd (-1)
+        , _event_fd (-1)
+        , _sleeping (false)
+        , _interrupted (false)
+    {
+        open_descriptors ();
+        start_worker ();
+    }
+
+    timerfd_work_queue::timerfd_work_queue (const size_t nexecutors,
+                                            const bool serialize_clients,
+                                            const work_queue::duration_type & spin,
+                                            const work_queue::timer_engine engine,
+                                            const work_queue::duration_type & tick)
+        : work_queue (work_queue::dont_start_worker (), engine, tick,
+                      nexecutors, serialize_clients)
+        , _spin ((spin.count () > 0) ? spin : work_queue::duration_type ())
+        , _timer_fd (-1)
+        , _event_fd (-1)
+        , _sleeping (false)
+        , _interrupted (false)
+    {
+        open_descriptors ();
+        start_worker ();
+    }
+
+    timerfd_work_queue::~timerfd_work_queue ()
+    {
+        kill_worker ();
+        if (_timer_fd >= 0)
+            ::close (_timer_fd);
+        if (_event_fd >= 0)
+            ::close (_event_fd);
+    }
+
+    void timerfd_work_queue::open_descriptors ()
+    {
+        /* steady_clock of libstdc++ and libc++ is CLOCK_MONOTONIC on Linux */
+        _timer_fd = ::timerfd_create (CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        _event_fd = ::eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if ((_timer_fd < 0) || (_event_fd < 0))
+        {
+            if (_timer_fd >= 0)
+                ::close (_timer_fd);
+            if (_event_fd >= 0)
+                ::close (_event_fd);
+            _timer_fd = _event_fd = -1;
+        }
+    }
+
+    bool timerfd_work_queue::is_timerfd_used () const
+    {
+        return (_timer_fd >= 0);
+    }
+
+    work_queue::duration_type timerfd_work_queue::get_spin () const
+    {
+        return _spin;
+    }
+
+    bool timerfd_work_queue::arm_timer (const work_queue::time_point_type & time_point)
+    {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds> (
+            time_point.time_since_epoch ()).count ();
+
+        itimerspec spec = {};
+        spec.it_value.tv_sec = static_cast<time_t> (ns / 1000000000);
+        spec.it_value.tv_nsec = static_cast<long> (ns % 1000000000);
+        return (0 == ::timerfd_settime (_timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr));
+    }
+
+    void timerfd_work_queue::clear_descriptors ()
+    {
+        uint64_t counter = 0;
+        while (::read (_timer_fd, &counter, sizeof (counter)) > 0)
+        { }
+        while (::read (_event_fd, &counter, sizeof (counter)) > 0)
+        { }
+    }
+
+    bool timerfd_work_queue::spin_until (work_queue::lock_type & guard,
+                                         const work_queue::time_point_type & time_point)
+    {
+        _interrupted = false;
+        if (get_container_change_flag (guard))
+            return false;
+
+        guard.unlock ();
+        while (!_interrupted.load (std::memory_order_relaxed) &&
+               (get_current_time_point () < time_point))
+        { }
+        guard.lock ();
+        return !get_container_change_flag (guard);
+    }
+
+    bool timerfd_work_queue::wait_for_time_point (
+        work_queue::lock_type & guard, const work_queue::time_point_type & time_point)
+    {
+        if (_timer_fd < 0)
+            return work_queue::wait_for_time_point (guard, time_point);
+
+        const work_queue::time_point_type wakeup_time_point = time_point - _spin;
+        for (;;)
+        {
+            if (get_container_change_flag (guard))
+            {
+                reset_container_change_flag (guard);
+                return false;
+            }
+
+            if (!(get_current_time_point () < wakeup_time_point))
+                break;
+            if (!arm_timer (wakeup_time_point))
+                return work_queue::wait_for_time_point (guard, time_point);
+
+            /* container change is signalled via eventfd, while worker sleeps */
+            _sleeping = true;
+            guard.unlock ();
+
+            pollfd fds[2] = {{_timer_fd, POLLIN, 0}, {_event_fd, POLLIN, 0}};
+            ::poll (fds, 2, -1);
+            clear_descriptors ();
+
+            guard.lock ();
+            _sleeping = false;
+        }
+
+        if ((0 < _spin.count ()) && !spin_until (guard, time_point))
+        {
+            reset_container_change_flag (guard);
+            return false;
+        }
+        return true;
+    }
+
+    void timerfd_work_queue::signal_container_change (work_queue::lock_type & guard)
+    {
+        work_queue::signal_container_change (guard);
+        _interrupted = true;
+        if (_sleeping)
+        {
+            const uint64_t increment = 1;
+            if (::write (_event_fd, &increment, sizeof (increment)) < 0)
+            { /* counter is already non-zero, so the worker is woken up anyway */ }
+        }
+    }
+} /* namespace mqmx */
+
+#endif /* __linux__ */
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <mqmx/libexport.h>
+#include <mqmx/work_queue.h>
+
+#include <atomic>
+
+#if defined(__linux__)
+
+namespace mqmx
+{
+    /**
+     * \brief Work queue with high resolution timer (Linux only).
+     *
+     * Worker of original class work_queue waits for time points on
+     * conditional variable, which precision depends on the system. This
+     * class waits for time points on timerfd (armed with absolute time of
+     * the monotonic clock) together with eventfd, which is signalled on
+     * changes of internal container.
+     *
+     * Optionally worker might wake up a bit earlier and spin until the
+     * time point, which trades CPU time for even lower lateness.
+     *
+     * \note If timerfd or eventfd cannot be created, the queue falls back
+     *       to the waiting of original class work_queue.
+     */
+    class MQMX_EXPORT timerfd_work_queue final : public work_queue
+    {
+        const work_queue::duration_type _spin;
+        int                             _timer_fd;
+        int                             _event_fd;
+        bool                            _sleeping;    /* worker is waiting on descriptors */
+        std::atomic<bool>               _interrupted; /* container changed while spinning */
+
+        void open_descriptors ();
+        bool arm_timer (const work_queue::time_point_type & time_point);
+        void clear_descriptors ();
+        bool spin_until (work_queue::lock_type & guard,
+                         const work_queue::time_point_type & time_point);
+
+        virtual bool
+        wait_for_time_point (work_queue::lock_type &,
+                             const work_queue::time_point_type &) final;
+
+        virtual void
+        signal_container_change (work_queue::lock_type &) final;
+
+    public:
+        /**
+         * \brief Constructor of work queue with single worker.
+         *
+         * \param spin is the time before each time point, worker spins
+         *        instead of sleeping (zero by default, i.e. no spinning)
+         * \param engine is the engine keeping scheduled works
+         * \param tick is the granularity of the timer wheel
+         */
+        explicit timerfd_work_queue (
+            const work_queue::duration_type & spin = work_queue::duration_type (),
+            const work_queue::timer_engine engine = work_queue::binary_heap,
+            const work_queue::duration_type & tick = work_queue::DEFAULT_TICK);
+
+        /**
+         * \brief Constructor of work queue with pool of executors.
+         *
+         * \param nexecutors is the number of executor threads
+         * \param serialize_clients if true, works of the same client are
+         *        never executed concurrently
+         * \param spin is the time before each time point, worker spins
+         *        instead of sleeping
+         * \param engine is the engine keeping scheduled works
+         * \param tick is the granularity of the timer wheel
+         */
+        timerfd_work_queue (
+            const size_t nexecutors,
+            const bool serialize_clients,
+            const work_queue::duration_type & spin = work_queue::duration_type (),
+            const work_queue::timer_engine engine = work_queue::binary_heap,
+            const work_queue::duration_type & tick = work_queue::DEFAULT_TICK);
+
+        /**
+         * \brief Virtual destructor.
+         */
+        virtual ~timerfd_work_queue ();
+
+        /**
+         * \brief Checks, whether timerfd is used for waiting (i.e. there
+         *        was no fallback to the original waiting).
+         */
+        bool is_timerfd_used () const;
+
+        /**
+         * \brief Returns spin time before each time point.
+         */
+        work_queue::duration_type get_spin () const;
+    };
+} /* namespace mqmx */
+
+#endif /* __linux__ */
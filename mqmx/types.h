@@ -17,9 +17,17 @@ namespace mqmx
 	HaltRequested,
 	PauseRequested,
 	NotAllowed,
+	Overflow,
     };
 
     typedef int    status_code;
     typedef size_t queue_id_type;
     typedef size_t message_id_type;
+
+    /**
+     * \brief Assumed size of CPU cache line.
+     *
+     * Used for separating data modified by different threads.
+     */
+    constexpr size_t cache_line_size = 64;
 } /* namespace mqmx */
@@ -0,0 +1,290 @@
+#pragma once
+
+#include <mqmx/libexport.h>
+#include <mqmx/message.h>
+
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace mqmx
+{
+    /**
+     * \brief Message envelope with inline (small-buffer) storage for the payload.
+     *
+     * In contrast to \link mqmx::message \endlink objects of this class are values,
+     * i.e. they could be stored directly inside of a container without extra
+     * allocation and indirection. Each envelope holds message queue ID, message ID
+     * and optional payload of an arbitrary type.
+     *
+     * Payloads which fit into N bytes (and could be moved without exceptions) are
+     * stored inline, bigger ones are allocated on the heap and envelope keeps just
+     * a pointer to them. In both cases the type of the payload is erased and could
+     * be checked at runtime with \link mqmx::basic_value_message::get \endlink.
+     *
+     * Envelope itself has a fixed size and is trivially relocatable for trivially
+     * copyable payloads (and for payloads on the heap), i.e. moving it is just
+     * a copy of a few machine words.
+     */
+    template <size_t N>
+    class basic_value_message
+    {
+        struct ops_type
+        {
+            const void * type_tag;
+            bool         is_inline;
+            void         (*relocate) (void * dst, void * src); /* nullptr for memcpy */
+            void         (*destroy) (void * storage);
+        };
+
+        template <typename T>
+        struct type_tag
+        {
+            static const char id;
+        };
+
+        template <typename T>
+        struct inline_ops
+        {
+            static void relocate (void * dst, void * src)
+            {
+                T * psrc = static_cast<T *> (src);
+                new (dst) T (std::move (*psrc));
+                psrc->~T ();
+            }
+
+            static void destroy (void * storage)
+            {
+                static_cast<T *> (storage)->~T ();
+            }
+
+            static const ops_type table;
+        };
+
+        template <typename T>
+        struct heap_ops
+        {
+            static void destroy (void * storage)
+            {
+                delete *static_cast<T **> (storage);
+            }
+
+            static const ops_type table;
+        };
+
+        template <typename T>
+        struct fits_inline : std::integral_constant<
+            bool,
+            (sizeof (T) <= N) &&
+            (alignof (T) <= alignof (std::max_align_t)) &&
+            std::is_nothrow_move_constructible<T>::value>
+        { };
+
+        /* storage goes first, so there is no padding between it and the header */
+        alignas (std::max_align_t) unsigned char _storage[N < sizeof (void *) ? sizeof (void *) : N];
+        queue_id_type    _qid;
+        message_id_type  _mid;
+        const ops_type * _ops;
+
+        template <typename T, typename... parameters>
+        void construct (std::true_type, parameters&&... args)
+        {
+            new (_storage) T (std::forward<parameters> (args)...);
+            _ops = &inline_ops<T>::table;
+        }
+
+        template <typename T, typename... parameters>
+        void construct (std::false_type, parameters&&... args)
+        {
+            *reinterpret_cast<T **> (_storage) = new T (std::forward<parameters> (args)...);
+            _ops = &heap_ops<T>::table;
+        }
+
+        void relocate_from (basic_value_message & o) noexcept
+        {
+            _qid = o._qid;
+            _mid = o._mid;
+            _ops = o._ops;
+            if (_ops)
+            {
+                if (_ops->relocate)
+                {
+                    _ops->relocate (_storage, o._storage);
+                }
+                else
+                {
+                    std::memcpy (_storage, o._storage, sizeof (_storage));
+                }
+                o._ops = nullptr;
+            }
+        }
+
+    public:
+        static constexpr size_t inline_capacity = N; ///< max size of inline payload
+
+        /**
+         * \brief Default constructor (empty envelope).
+         */
+        basic_value_message () noexcept
+            : _qid (message::undefined_qid)
+            , _mid (0)
+            , _ops (nullptr)
+        { }
+
+        /**
+         * \brief Constructor of envelope without payload.
+         */
+        basic_value_message (const queue_id_type queue_id,
+                             const message_id_type message_id) noexcept
+            : _qid (queue_id)
+            , _mid (message_id)
+            , _ops (nullptr)
+        { }
+
+        basic_value_message (const basic_value_message &) = delete;
+        basic_value_message & operator = (const basic_value_message &) = delete;
+
+        basic_value_message (basic_value_message && o) noexcept
+            : _qid (message::undefined_qid)
+            , _mid (0)
+            , _ops (nullptr)
+        {
+            relocate_from (o);
+        }
+
+        basic_value_message & operator = (basic_value_message && o) noexcept
+        {
+            if (this != &o)
+            {
+                reset ();
+                relocate_from (o);
+            }
+            return *this;
+        }
+
+        ~basic_value_message ()
+        {
+            reset ();
+        }
+
+        /**
+         * \brief Create envelope with payload of given type.
+         *
+         * \param queue_id is an ID of the queue to which message belongs
+         * \param message_id is an ID of the message
+         * \param args are forwarded to the constructor of payload
+         */
+        template <typename payload_type, typename... parameters>
+        static basic_value_message make (const queue_id_type queue_id,
+                                         const message_id_type message_id,
+                                         parameters&&... args)
+        {
+            basic_value_message result (queue_id, message_id);
+            result.template construct<payload_type> (
+                fits_inline<payload_type> (), std::forward<parameters> (args)...);
+            return result;
+        }
+
+        /**
+         * \brief Destroy the payload (if any).
+         */
+        void reset () noexcept
+        {
+            if (_ops)
+            {
+                _ops->destroy (_storage);
+                _ops = nullptr;
+            }
+        }
+
+        /**
+         * \returns ID of the queue to which this message belongs
+         */
+        queue_id_type get_qid () const
+        {
+            return _qid;
+        }
+
+        /**
+         * \returns ID of the message
+         */
+        message_id_type get_mid () const
+        {
+            return _mid;
+        }
+
+        /**
+         * \returns true if envelope has some payload
+         */
+        bool has_payload () const
+        {
+            return (_ops != nullptr);
+        }
+
+        /**
+         * \returns true if payload is stored inside of the envelope
+         */
+        bool is_inline () const
+        {
+            return (_ops != nullptr) && _ops->is_inline;
+        }
+
+        /**
+         * \returns Pointer to the payload or nullptr if envelope has no payload
+         *          or payload has different type.
+         */
+        template <typename payload_type>
+        payload_type * get ()
+        {
+            if ((_ops == nullptr) || (_ops->type_tag != &type_tag<payload_type>::id))
+            {
+                return nullptr;
+            }
+
+            return (_ops->is_inline
+                    ? reinterpret_cast<payload_type *> (_storage)
+                    : *reinterpret_cast<payload_type **> (_storage));
+        }
+
+        /**
+         * \returns Pointer to the payload or nullptr if envelope has no payload
+         *          or payload has different type.
+         */
+        template <typename payload_type>
+        const payload_type * get () const
+        {
+            return const_cast<basic_value_message *> (this)->template get<payload_type> ();
+        }
+    };
+
+    template <size_t N>
+    constexpr size_t basic_value_message<N>::inline_capacity;
+
+    template <size_t N>
+    template <typename T>
+    const char basic_value_message<N>::type_tag<T>::id = 0;
+
+    template <size_t N>
+    template <typename T>
+    const typename basic_value_message<N>::ops_type basic_value_message<N>::inline_ops<T>::table = {
+        &basic_value_message<N>::type_tag<T>::id,
+        true,
+        std::is_trivially_copyable<T>::value ? nullptr : &basic_value_message<N>::inline_ops<T>::relocate,
+        &basic_value_message<N>::inline_ops<T>::destroy
+    };
+
+    template <size_t N>
+    template <typename T>
+    const typename basic_value_message<N>::ops_type basic_value_message<N>::heap_ops<T>::table = {
+        &basic_value_message<N>::type_tag<T>::id,
+        false,
+        nullptr,
+        &basic_value_message<N>::heap_ops<T>::destroy
+    };
+
+    /**
+     * \brief Message envelope occupying single cache line (on 64-bit systems).
+     */
+    typedef basic_value_message<40> value_message;
+} /* namespace mqmx */
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <mqmx/libexport.h>
+#include <mqmx/message_queue.h>
+#include <mqmx/value_message.h>
+
+#include <algorithm>
+#include <deque>
+#include <iterator>
+
+namespace mqmx
+{
+    /**
+     * \brief Message queue (FIFO) storing value messages inline.
+     *
+     * Messages are \link mqmx::basic_value_message \endlink envelopes kept
+     * directly in the container, so neither push nor pop of a message with
+     * small payload performs dedicated allocation or pointer chasing.
+     *
+     * Listener semantics are the same as for \link mqmx::message_queue \endlink,
+     * so queues of this class could be polled by \link mqmx::poll \endlink.
+     *
+     * Queue is not a \link mqmx::message_queue \endlink (only listener related
+     * part of its interface is exposed), since it doesn't hold
+     * \link mqmx::message \endlink pointers. Consequently this queue could
+     * not be served by \link mqmx::message_queue_pool \endlink.
+     *
+     * \note Objects of this class could not be moved.
+     */
+    template <size_t N = value_message::inline_capacity>
+    class value_message_queue final : private message_queue
+    {
+        value_message_queue (const value_message_queue &) = delete;
+        value_message_queue & operator = (const value_message_queue &) = delete;
+        value_message_queue (value_message_queue &&) = delete;
+        value_message_queue & operator = (value_message_queue &&) = delete;
+
+    public:
+        typedef basic_value_message<N>  value_type;
+        typedef std::deque<value_type>  value_container_type;
+
+        using message_queue::mutex_type;
+        using message_queue::lock_type;
+        using message_queue::notification_flags_type;
+        using message_queue::notification_flag;
+        using message_queue::listener;
+
+        using message_queue::get_qid;
+        using message_queue::clear_listener;
+        using message_queue::set_stats;
+        using message_queue::get_stats;
+
+        /**
+         * \brief Constructor.
+         */
+        value_message_queue (const queue_id_type qid = message::undefined_qid)
+            : message_queue (qid)
+            , _values ()
+        { }
+
+        /**
+         * \brief Destructor.
+         */
+        virtual ~value_message_queue ()
+        { }
+
+        /**
+         * \brief Push some message to the end of the queue.
+         *
+         * \see \link mqmx::message_queue::push \endlink for notification semantics
+         *
+         * \retval ExitStatus::Success       if operation completed successfully
+         * \retval ExitStatus::NotSupported  if message doesn't belong to this
+         *                                   message queue (has different QID)
+         */
+        status_code push_value (value_type && msg)
+        {
+            if ((_id == message::undefined_qid) ||
+                (_id != msg.get_qid ()))
+            {
+                return ExitStatus::NotSupported;
+            }
+
+            lock_type guard (_mutex);
+            if (_stats)
+            {
+                /* values are not stamped, so time in queue is not measured */
+                _stats->pushed (1);
+            }
+            _values.push_back (std::move (msg));
+            if (_listener && (_values.size () == 1))
+            {
+                /* only first message will be reported */
+                _listener->notify (_id, this, notification_flag::data);
+            }
+            return ExitStatus::Success;
+        }
+
+        /**
+         * \brief Create and push message with given payload to the end of the queue.
+         *
+         * \returns The same set of status codes that could be returned from the
+         *          \link mqmx::value_message_queue::push_value \endlink method
+         */
+        template <typename payload_type, typename... parameters>
+        status_code enqueue_value (const message_id_type mid, parameters&&... args)
+        {
+            return push_value (value_type::template make<payload_type> (
+                                   get_qid (), mid, std::forward<parameters> (args)...));
+        }
+
+        /**
+         * \brief Push message without payload to the end of the queue.
+         *
+         * \returns The same set of status codes that could be returned from the
+         *          \link mqmx::value_message_queue::push_value \endlink method
+         */
+        status_code enqueue_value (const message_id_type mid)
+        {
+            return push_value (value_type (get_qid (), mid));
+        }
+
+        /**
+         * \brief Remove message from the top of the queue.
+         *
+         * \param msg receives the message
+         *
+         * \returns true if message was removed or false if queue is empty.
+         */
+        bool pop_value (value_type & msg)
+        {
+            lock_type guard (_mutex);
+            if (_values.empty ())
+            {
+                return false;
+            }
+
+            msg = std::move (_values.front ());
+            _values.pop_front ();
+            if (_stats)
+            {
+                _stats->popped (1);
+            }
+            return true;
+        }
+
+        /**
+         * \brief Remove a number of messages from the top of the queue.
+         *
+         * \see \link mqmx::message_queue::drain \endlink
+         */
+        size_t drain_values (value_container_type & out,
+                             const size_t max = static_cast<size_t> (-1))
+        {
+            lock_type guard (_mutex);
+            const size_t count = std::min (max, _values.size ());
+            if ((count == _values.size ()) && out.empty ())
+            {
+                std::swap (_values, out);
+            }
+            else
+            {
+                const auto last = std::next (std::begin (_values), count);
+                out.insert (std::end (out),
+                            std::make_move_iterator (std::begin (_values)),
+                            std::make_move_iterator (last));
+                _values.erase (std::begin (_values), last);
+            }
+
+            if (_stats && count)
+            {
+                _stats->popped (count);
+            }
+            return count;
+        }
+
+        /**
+         * \brief Sets new listener for this message queue.
+         *
+         * \see \link mqmx::message_queue::set_listener \endlink
+         */
+        virtual status_code set_listener (listener & l) override
+        {
+            lock_type guard (_mutex);
+            if (_listener)
+            {
+                return ExitStatus::AlreadyExist;
+            }
+
+            _listener = &l;
+            if (!_values.empty ())
+            {
+                _listener->notify (_id, this, notification_flag::data);
+            }
+            return ExitStatus::Success;
+        }
+
+    private:
+        /*
+         * Messages of the base class are not supported. These are still
+         * reachable through the pointer passed to the listener.
+         */
+        virtual status_code push (message::upointer_type &&) override
+        {
+            return ExitStatus::NotSupported;
+        }
+
+        virtual message::upointer_type pop () override
+        {
+            return message::upointer_type ();
+        }
+
+        virtual status_code push_batch (container_type &) override
+        {
+            return ExitStatus::NotSupported;
+        }
+
+        virtual size_t drain (container_type &, const size_t = static_cast<size_t> (-1)) override
+        {
+            return 0;
+        }
+
+        value_container_type _values;
+    };
+} /* namespace mqmx */
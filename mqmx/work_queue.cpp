@@ -1,4 +1,5 @@
 #include <mqmx/work_queue.h>
+#include <mqmx/work_queue_storage.h>
 #include <algorithm>
 
 namespace mqmx
@@ -9,45 +10,194 @@ namespace mqmx
         static_cast<work_queue::work_id_type> (-1);
     const work_queue::duration_type work_queue::RUN_ONCE =
         work_queue::duration_type ();
+    const work_queue::duration_type work_queue::DEFAULT_TICK =
+        std::chrono::milliseconds (1);
+    const size_t work_queue::DEFAULT_IMMEDIATE_BURST = 64;
 
     work_queue::wq_item::wq_item ()
         : time_point ()
         , client_id (INVALID_CLIENT_ID)
         , work ()
         , period ()
+        , policy (fixed_rate)
+        , skipped (0)
     { }
 
     work_queue::wq_item::wq_item (
         const work_queue::time_point_type & tpoint,
         const work_queue::client_id_type clientid,
         const work_queue::work_pointer_type & pwork,
-        const work_queue::duration_type & tperiod)
+        const work_queue::duration_type & tperiod,
+        const work_queue::periodic_policy tpolicy)
         : time_point (tpoint)
         , client_id (clientid)
         , work (pwork)
         , period (tperiod)
+        , policy (tpolicy)
+        , skipped (0)
     { }
 
-    work_queue::work_queue ()
-        : work_queue (dont_start_worker ())
+    work_queue::work_entry::work_entry (
+        const work_queue::work_pointer_type & pwork,
+        const work_queue::time_point_type & tstart,
+        const work_queue::duration_type & tperiod,
+        const work_queue::periodic_policy tpolicy)
+        : work (pwork)
+        , start_time (tstart)
+        , period (tperiod)
+        , policy (tpolicy)
+    { }
+
+    work_queue::work_queue (const timer_engine engine, const duration_type & tick)
+        : work_queue (dont_start_worker (), engine, tick)
+    {
+        start_worker ();
+    }
+
+    work_queue::work_queue (const size_t nexecutors,
+                            const bool serialize_clients,
+                            const timer_engine engine,
+                            const duration_type & tick)
+        : work_queue (dont_start_worker (), engine, tick, nexecutors, serialize_clients)
     {
         start_worker ();
     }
 
-    work_queue::work_queue (const dont_start_worker)
+    work_queue::work_queue (const dont_start_worker,
+                            const timer_engine engine,
+                            const duration_type & tick,
+                            const size_t nexecutors,
+                            const bool serialize_clients)
         : _next_work_id (INVALID_WORK_ID)
         , _next_client_id (INVALID_CLIENT_ID)
         , _mutex ()
         , _container_change_condition ()
-        , _wq_item_container ()
+        , _wq_item_container (engine == timer_wheel
+                              ? static_cast<timer_storage *> (new wheel_timer_storage (tick))
+                              : static_cast<timer_storage *> (new heap_timer_storage ()))
         , _container_change_flag (false)
         , _worker_stopped_flag (true)
+        , _inbox (nullptr)
         , _worker ()
+        , _nexecutors (nexecutors)
+        , _serialize_clients ((nexecutors > 0) && serialize_clients)
+        , _executors ()
+        , _ready_condition ()
+        , _ready ()
+        , _running ()
+        , _busy_clients ()
+        , _executors_stop_flag (false)
+        , _slack ()
+        , _immediate_works ()
+        , _immediate_burst (DEFAULT_IMMEDIATE_BURST)
     { }
 
     work_queue::~work_queue ()
     {
         kill_worker ();
+
+        /* works scheduled concurrently with termination */
+        lock_type guard (_mutex);
+        drain_inbox (guard);
+    }
+
+    work_queue::work_id_type work_queue::get_next_work_id ()
+    {
+        work_id_type work_id = ++_next_work_id;
+        if (work_id == INVALID_WORK_ID)
+            work_id = ++_next_work_id;
+        return work_id;
+    }
+
+    bool work_queue::push_to_inbox (work_queue::inbox_node * node)
+    {
+        inbox_node * head = _inbox.load (std::memory_order_relaxed);
+        do
+            node->next = head;
+        while (!_inbox.compare_exchange_weak (
+                   head, node, std::memory_order_release, std::memory_order_relaxed));
+
+        /* node might be already drained, so it's not touched anymore;
+         * the only pusher into empty inbox has to wake the worker up */
+        return !head;
+    }
+
+    void work_queue::drain_inbox (work_queue::lock_type & /*guard*/)
+    {
+        inbox_node * head = _inbox.exchange (nullptr, std::memory_order_acquire);
+
+        /* inbox is LIFO, it's reversed to insert records in order of scheduling */
+        inbox_node * node = nullptr;
+        size_t count = 0;
+        while (head)
+        {
+            inbox_node * const next = head->next;
+            head->next = node;
+            node = head;
+            head = next;
+            ++count;
+        }
+
+        /* works scheduled after termination are discarded */
+        const bool discard = _worker_stopped_flag;
+        std::vector<record_type> records;
+        if (!discard && (count > 1))
+            records.reserve (count);
+
+        while (node)
+        {
+            std::unique_ptr<inbox_node> drained (node);
+            node = drained->next;
+            if (discard)
+                continue;
+            if (is_time_point_empty (drained->record.first.time_point))
+                _immediate_works.push_back (std::move (drained->record));
+            else if (count > 1)
+                records.push_back (std::move (drained->record));
+            else
+                _wq_item_container->insert (std::move (drained->record));
+        }
+
+        if (!records.empty ())
+            _wq_item_container->insert (std::move (records));
+    }
+
+    bool work_queue::has_inbox_works (work_queue::lock_type & /*guard*/) const
+    {
+        return !_worker_stopped_flag && _inbox.load (std::memory_order_acquire);
+    }
+
+    const work_queue::record_type * work_queue::find_inbox_work (
+        work_queue::lock_type & guard, const work_queue::work_id_type work_id) const
+    {
+        if (!has_inbox_works (guard))
+            return nullptr;
+
+        for (const inbox_node * node = _inbox.load (std::memory_order_acquire);
+             node; node = node->next)
+        {
+            if (node->record.second == work_id)
+                return &node->record;
+        }
+        return nullptr;
+    }
+
+    work_queue::time_point_type work_queue::get_inbox_nearest_time_point (
+        work_queue::lock_type & guard) const
+    {
+        time_point_type nearest = get_empty_time_point ();
+        if (!has_inbox_works (guard))
+            return nearest;
+
+        for (const inbox_node * node = _inbox.load (std::memory_order_acquire);
+             node; node = node->next)
+        {
+            const time_point_type & time_point = node->record.first.time_point;
+            if (!is_time_point_empty (time_point) &&
+                (is_time_point_empty (nearest) || (time_point < nearest)))
+                nearest = time_point;
+        }
+        return nearest;
     }
 
     std::pair<status_code, work_queue::work_id_type> work_queue::post_work (
@@ -57,40 +207,128 @@ namespace mqmx
         if (_worker_stopped_flag)
             return std::make_pair (ExitStatus::NotAllowed, INVALID_WORK_ID);
 
-        if (++_next_work_id == INVALID_WORK_ID)
-            ++_next_work_id;
-
-        _wq_item_container.push_back (std::make_pair (item, _next_work_id));
-        std::push_heap (std::begin (_wq_item_container),
-                        std::end (_wq_item_container),
-                        record_compare ());
+        const work_id_type work_id = get_next_work_id ();
+        _wq_item_container->insert (std::make_pair (std::move (item), work_id));
 
         signal_container_change (guard);
-        return std::make_pair(ExitStatus::Success, _next_work_id);
+        return std::make_pair(ExitStatus::Success, work_id);
     }
 
     bool work_queue::is_idle () const
     {
         lock_type guard (_mutex);
 
-        return is_container_empty (guard);
+        return is_container_empty (guard) && _immediate_works.empty () && _running.empty () &&
+            !has_inbox_works (guard);
+    }
+
+    size_t work_queue::get_executors_count () const
+    {
+        return _nexecutors;
+    }
+
+    void work_queue::set_slack (const duration_type & slack)
+    {
+        lock_type guard (_mutex);
+        _slack = (slack.count () > 0) ? slack : duration_type ();
+    }
+
+    work_queue::duration_type work_queue::get_slack () const
+    {
+        lock_type guard (_mutex);
+        return _slack;
+    }
+
+    void work_queue::set_immediate_burst (const size_t burst)
+    {
+        lock_type guard (_mutex);
+        _immediate_burst = burst;
+    }
+
+    size_t work_queue::get_immediate_burst () const
+    {
+        lock_type guard (_mutex);
+        return _immediate_burst;
     }
 
     std::pair<status_code, work_queue::work_id_type> work_queue::schedule_work (
         const client_id_type client_id,
         const work_pointer_type & work,
         const time_point_type & start_time,
-        const duration_type & repeat_period)
+        const duration_type & repeat_period,
+        const periodic_policy policy)
     {
         if ((client_id == INVALID_CLIENT_ID) || !work)
             return std::make_pair (ExitStatus::InvalidArgument, INVALID_WORK_ID);
 
-        time_point_type stime =
-            is_time_point_empty (start_time) ? get_current_time_point () : start_time;
+        /* immediate works are kept without time point */
+        time_point_type stime = start_time;
+        if (is_time_point_empty (start_time) && (0 < repeat_period.count ()))
+            stime = get_current_time_point ();
+
+        if (_worker_stopped_flag)
+            return std::make_pair (ExitStatus::NotAllowed, INVALID_WORK_ID);
+
+        const work_id_type work_id = get_next_work_id ();
+        if (push_to_inbox (new inbox_node {
+                    record_type ({stime, client_id, work, repeat_period, policy}, work_id),
+                    nullptr}))
+        {
+            lock_type guard (_mutex);
+            signal_container_change (guard);
+        }
+        return std::make_pair (ExitStatus::Success, work_id);
+    }
+
+    std::pair<status_code, work_queue::work_ids_type> work_queue::schedule_works (
+        const client_id_type client_id, const work_entries_type & works)
+    {
+        work_ids_type work_ids;
+        if (client_id == INVALID_CLIENT_ID)
+            return std::make_pair (ExitStatus::InvalidArgument, work_ids);
+
+        for (const auto & entry : works)
+        {
+            if (!entry.work)
+                return std::make_pair (ExitStatus::InvalidArgument, work_ids);
+        }
+
+        const time_point_type now = get_current_time_point ();
+        std::vector<record_type> records;
+        records.reserve (works.size ());
+        work_ids.reserve (works.size ());
 
         lock_type guard (_mutex);
 
-        return post_work (guard, {stime, client_id, work, repeat_period});
+        if (_worker_stopped_flag)
+            return std::make_pair (ExitStatus::NotAllowed, work_ids);
+
+        /* works scheduled earlier go first to the lane of immediate works */
+        drain_inbox (guard);
+        for (const auto & entry : works)
+        {
+            const work_id_type work_id = get_next_work_id ();
+            work_ids.push_back (work_id);
+            if (is_time_point_empty (entry.start_time) && (0 >= entry.period.count ()))
+            {
+                _immediate_works.emplace_back (
+                    wq_item (entry.start_time, client_id, entry.work, entry.period, entry.policy),
+                    work_id);
+                continue;
+            }
+
+            const time_point_type stime =
+                is_time_point_empty (entry.start_time) ? now : entry.start_time;
+            records.emplace_back (
+                wq_item (stime, client_id, entry.work, entry.period, entry.policy),
+                work_id);
+        }
+
+        if (!records.empty ())
+            _wq_item_container->insert (std::move (records));
+        if (!works.empty ())
+            signal_container_change (guard);
+        return std::make_pair (ExitStatus::Success, work_ids);
     }
 
     bool work_queue::signal_worker_to_stop ()
@@ -100,7 +338,8 @@ namespace mqmx
         if (_worker_stopped_flag)
             return false;
 
-        _wq_item_container.clear ();
+        _wq_item_container->clear ();
+        _immediate_works.clear ();
 
         status_code sc = ExitStatus::Success;
         work_id_type work_id = INVALID_WORK_ID;
@@ -108,6 +347,7 @@ namespace mqmx
         if (sc == ExitStatus::Success)
         {
             _worker_stopped_flag = true;
+            drain_inbox (guard);
             return true;
         }
         return false;
@@ -134,6 +374,10 @@ namespace mqmx
         std::thread wrk ([this]{ worker (); });
         std::swap (wrk, _worker);
 
+        _executors_stop_flag = false;
+        for (size_t i = 0; i < _nexecutors; ++i)
+            _executors.emplace_back ([this]{ executor (); });
+
         _worker_stopped_flag = false;
         return ExitStatus::Success;
     }
@@ -143,31 +387,128 @@ namespace mqmx
         if (signal_worker_to_stop () && _worker.joinable ())
         {
             _worker.join ();
+            stop_executors ();
             return ExitStatus::Success;
         }
         return ExitStatus::NotAllowed;
     }
 
-    void work_queue::make_heap_and_notify_worker (work_queue::lock_type & guard)
+    void work_queue::stop_executors ()
     {
-        std::make_heap (std::begin (_wq_item_container),
-                        std::end (_wq_item_container),
-                        record_compare ());
-        signal_container_change (guard);
+        {
+            lock_type guard (_mutex);
+            _executors_stop_flag = true;
+            _ready_condition.notify_all ();
+        }
+
+        /* works being executed are completed, dispatched ones are discarded */
+        for (auto & executor : _executors)
+            executor.join ();
+        _executors.clear ();
+
+        lock_type guard (_mutex);
+        _ready.clear ();
+        _running.clear ();
+        _busy_clients.clear ();
     }
 
-    bool work_queue::wq_item_find_and_replace (
-        lock_type & /*guard*/, const work_id_type work_id, const wq_item & new_item)
+    void work_queue::dispatch_work (work_queue::lock_type & /*guard*/,
+                                    work_queue::record_type && record)
     {
-        for (auto & elem : _wq_item_container)
+        const client_id_type client_id = record.first.client_id;
+        _running[record.second] =
+            running_state {client_id, false, false, wq_item (), record.first.skipped};
+
+        if (_serialize_clients)
         {
-            if (elem.second == work_id)
+            auto it = _busy_clients.find (client_id);
+            if (it != _busy_clients.end ())
             {
-                elem.first = new_item;
-                return true;
+                it->second.push_back (std::move (record));
+                return;
             }
+            _busy_clients[client_id];
+        }
+
+        _ready.push_back (std::move (record));
+        _ready_condition.notify_one ();
+    }
+
+    void work_queue::complete_work (work_queue::lock_type & guard,
+                                    work_queue::record_type && record,
+                                    const work_queue::time_point_type & next_time_point)
+    {
+        auto it = _running.find (record.second);
+        const running_state state = std::move (it->second);
+        _running.erase (it);
+
+        const client_id_type client_id = record.first.client_id;
+        if (!state.cancelled && !_worker_stopped_flag)
+        {
+            bool reschedule = true;
+            if (state.updated)
+                record.first = state.item;
+            else if (!is_time_point_empty (next_time_point))
+            {
+                const wq_item & item = record.first;
+                if ((item.policy == fixed_rate_skip) && (0 < item.period.count ()) &&
+                    (item.time_point + item.period < next_time_point))
+                {
+                    record.first.skipped +=
+                        (next_time_point - item.time_point) / item.period - 1;
+                }
+                record.first.time_point = next_time_point;
+            }
+            else
+                reschedule = false;
+
+            if (reschedule)
+            {
+                _wq_item_container->insert (std::move (record));
+                if (_nexecutors)
+                    signal_container_change (guard);
+            }
+        }
+
+        if (_serialize_clients)
+        {
+            auto busy = _busy_clients.find (client_id);
+            if (busy->second.empty ())
+                _busy_clients.erase (busy);
+            else
+            {
+                _ready.push_back (std::move (busy->second.front ()));
+                busy->second.pop_front ();
+                _ready_condition.notify_one ();
+            }
+        }
+    }
+
+    void work_queue::executor ()
+    {
+        lock_type guard (_mutex);
+        for (;;)
+        {
+            _ready_condition.wait (guard, [&]{
+                    return _executors_stop_flag || !_ready.empty ();
+                });
+            if (_executors_stop_flag)
+                break;
+
+            record_type item = std::move (_ready.front ());
+            _ready.pop_front ();
+
+            /* work cancelled or updated before execution is not executed */
+            auto next_time_point = get_empty_time_point ();
+            const running_state & state = _running.find (item.second)->second;
+            if (!state.cancelled && !state.updated)
+            {
+                guard.unlock ();
+                next_time_point = execute_work (guard, item);
+                guard.lock ();
+            }
+            complete_work (guard, std::move (item), next_time_point);
         }
-        return false;
     }
 
     status_code work_queue::update_work (
@@ -175,7 +516,8 @@ namespace mqmx
         const client_id_type client_id,
         const work_pointer_type & work,
         const time_point_type & start_time,
-        const duration_type & repeat_period)
+        const duration_type & repeat_period,
+        const periodic_policy policy)
     {
         if ((client_id == INVALID_CLIENT_ID) || !work)
             return ExitStatus::InvalidArgument;
@@ -185,28 +527,52 @@ namespace mqmx
         if (_worker_stopped_flag)
             return ExitStatus::NotAllowed;
 
-        if (wq_item_find_and_replace (
-                guard, work_id, {start_time, client_id, work, repeat_period}))
+        drain_inbox (guard);
+        if (_wq_item_container->replace (
+                work_id, {start_time, client_id, work, repeat_period, policy}))
         {
-            make_heap_and_notify_worker (guard);
+            signal_container_change (guard);
+            return ExitStatus::Success;
+        }
+
+        auto immediate = find_immediate_work (work_id);
+        if (immediate != _immediate_works.end ())
+        {
+            _immediate_works.erase (immediate);
+            _wq_item_container->insert (std::make_pair (
+                    wq_item (start_time, client_id, work, repeat_period, policy), work_id));
+            signal_container_change (guard);
+            return ExitStatus::Success;
+        }
+
+        auto it = _running.find (work_id);
+        if ((it != _running.end ()) && !it->second.cancelled)
+        {
+            it->second.client_id = client_id;
+            it->second.updated = true;
+            it->second.item = {start_time, client_id, work, repeat_period, policy};
             return ExitStatus::Success;
         }
         return ExitStatus::NotFound;
     }
 
-    bool work_queue::wq_item_find_and_remove (
-        lock_type & /*guard*/, const work_id_type work_id)
+    std::pair<status_code, unsigned long> work_queue::get_skipped_count (
+        const work_id_type work_id) const
     {
-        for (auto & elem : _wq_item_container)
-        {
-            if (elem.second == work_id)
-            {
-                std::swap (elem, _wq_item_container.back ());
-                _wq_item_container.pop_back ();
-                return true;
-            }
-        }
-        return false;
+        lock_type guard (_mutex);
+
+        const record_type * record = _wq_item_container->find (work_id);
+        if (!record)
+            record = find_inbox_work (guard, work_id);
+        if (record)
+            return std::make_pair (ExitStatus::Success, record->first.skipped);
+        if (find_immediate_work (work_id) != _immediate_works.cend ())
+            return std::make_pair (ExitStatus::Success, 0UL);
+
+        auto it = _running.find (work_id);
+        if (it != _running.end ())
+            return std::make_pair (ExitStatus::Success, it->second.skipped);
+        return std::make_pair (ExitStatus::NotFound, 0UL);
     }
 
     status_code work_queue::cancel_work (const work_queue::work_id_type work_id)
@@ -216,9 +582,24 @@ namespace mqmx
         if (_worker_stopped_flag)
             return ExitStatus::NotAllowed;
 
-        if (wq_item_find_and_remove (guard, work_id))
+        drain_inbox (guard);
+        if (_wq_item_container->remove (work_id))
+        {
+            signal_container_change (guard);
+            return ExitStatus::Success;
+        }
+
+        auto immediate = find_immediate_work (work_id);
+        if (immediate != _immediate_works.end ())
+        {
+            _immediate_works.erase (immediate);
+            return ExitStatus::Success;
+        }
+
+        auto it = _running.find (work_id);
+        if ((it != _running.end ()) && !it->second.cancelled)
         {
-            make_heap_and_notify_worker (guard);
+            it->second.cancelled = true;
             return ExitStatus::Success;
         }
         return ExitStatus::NotFound;
@@ -233,18 +614,24 @@ namespace mqmx
     work_queue::time_point_type work_queue::get_nearest_time_point (
         lock_type & guard) const
     {
+        const time_point_type inbox_time_point = get_inbox_nearest_time_point (guard);
         if (is_container_empty (guard))
-            return get_empty_time_point ();
+            return inbox_time_point;
 
-        return _wq_item_container.front ().first.time_point;
+        const time_point_type & time_point = _wq_item_container->top ().first.time_point;
+        if (is_time_point_empty (inbox_time_point) || (time_point < inbox_time_point))
+            return time_point;
+        return inbox_time_point;
     }
 
     bool work_queue::wait_for_some_work (work_queue::lock_type & guard)
     {
         _container_change_condition.wait (guard, [&]{
-                return !is_container_empty (guard);
+                drain_inbox (guard);
+                return !_immediate_works.empty () || !is_container_empty (guard);
             });
-        return static_cast<bool> (_wq_item_container.front ().first.work);
+        return is_container_empty (guard) ||
+            static_cast<bool> (_wq_item_container->top ().first.work);
     }
 
     bool work_queue::get_container_change_flag (work_queue::lock_type & /*guard*/) const
@@ -266,19 +653,47 @@ namespace mqmx
     }
 
     work_queue::time_point_type work_queue::execute_work (
-        lock_type & /*guard*/, const work_queue::record_type & rec)
+        lock_type & guard, const work_queue::record_type & rec)
     {
-        auto rescheduled_work_time_point = get_empty_time_point ();
+        const bool locked = guard.owns_lock ();
+        if (locked)
+            guard.unlock ();
+
+        bool rescheduling_needed = false;
         try
         {
-            const bool rescheduling_needed =
+            rescheduling_needed =
                 rec.first.work (rec.second) && (0 < rec.first.period.count ());
-            if (rescheduling_needed)
-                rescheduled_work_time_point = rec.first.time_point + rec.first.period;
         }
         catch (...)
         {
         }
+
+        const wq_item & item = rec.first;
+        auto rescheduled_work_time_point = get_empty_time_point ();
+        if (rescheduling_needed)
+        {
+            rescheduled_work_time_point = item.time_point + item.period;
+            if (item.policy != fixed_rate)
+            {
+                /* current time is taken before the lock is acquired again,
+                 * since derived classes might need main mutex for it */
+                const time_point_type now = get_current_time_point ();
+                if (item.policy == fixed_delay)
+                    rescheduled_work_time_point = now + item.period;
+                else if (rescheduled_work_time_point < now)
+                {
+                    /* the nearest time point of the grid not in the past */
+                    rescheduled_work_time_point =
+                        item.time_point + ((now - item.time_point) / item.period) * item.period;
+                    if (rescheduled_work_time_point < now)
+                        rescheduled_work_time_point += item.period;
+                }
+            }
+        }
+
+        if (locked)
+            guard.lock ();
         return rescheduled_work_time_point;
     }
 
@@ -287,60 +702,97 @@ namespace mqmx
         return time_point_type ();
     }
 
+    void work_queue::run_work (work_queue::lock_type & guard, work_queue::record_type && item)
+    {
+        if (_nexecutors)
+        {
+            dispatch_work (guard, std::move (item));
+            return;
+        }
+
+        _running[item.second] = running_state {
+            item.first.client_id, false, false, wq_item (), item.first.skipped};
+        const auto rescheduled_work_time_point = execute_work (guard, item);
+        complete_work (guard, std::move (item), rescheduled_work_time_point);
+    }
+
     void work_queue::worker ()
     {
         lock_type guard (_mutex);
+
+        /* all works up to this time point are executed without waiting */
+        time_point_type batch_end_time_point = get_empty_time_point ();
+
+        /* timers up to this time point are executed before immediate works */
+        time_point_type timers_due_time_point = get_empty_time_point ();
+        size_t immediate_count = 0;
         for (;;)
         {
             if (!wait_for_some_work (guard))
             {
                 // got termination notification - exit thread
-                _wq_item_container.clear ();
+                _wq_item_container->clear ();
                 break;
             }
 
-            if (!wait_for_time_point (guard, _wq_item_container.front ().first.time_point) ||
-                is_container_empty (guard))
+            if (!_immediate_works.empty () &&
+                (is_container_empty (guard) ||
+                 (timers_due_time_point < _wq_item_container->top ().first.time_point)))
             {
-                // timer queue has been changed - we have to restart the loop
+                /* at least one immediate work is executed after timers check */
+                if (is_container_empty (guard) ||
+                    (immediate_count < std::max<size_t> (_immediate_burst, 1)))
+                {
+                    ++immediate_count;
+                    record_type item = std::move (_immediate_works.front ());
+                    _immediate_works.pop_front ();
+                    run_work (guard, std::move (item));
+                    continue;
+                }
+
+                /* burst is over - timers due by now go first; current time is
+                 * taken with released mutex, since derived classes might need it */
+                immediate_count = 0;
+                guard.unlock ();
+                const time_point_type now = get_current_time_point ();
+                guard.lock ();
+                timers_due_time_point = now;
                 continue;
             }
+            immediate_count = 0;
 
-            std::pop_heap (std::begin (_wq_item_container), std::end (_wq_item_container),
-                           record_compare ());
-            record_type item = std::move (_wq_item_container.back ());
-            _wq_item_container.pop_back ();
-
-            const auto rescheduled_work_time_point = execute_work (guard, item);
-            if (!is_time_point_empty (rescheduled_work_time_point))
+            /* a copy, since the storage might be changed while waiting */
+            const time_point_type nearest_time_point =
+                _wq_item_container->top ().first.time_point;
+            if (batch_end_time_point < nearest_time_point)
             {
-                item.first.time_point = rescheduled_work_time_point;
-                _wq_item_container.push_back (std::move (item));
-                std::push_heap (std::begin (_wq_item_container),
-                                std::end (_wq_item_container),
-                                record_compare ());
+                if (!wait_for_time_point (guard, nearest_time_point) ||
+                    is_container_empty (guard))
+                {
+                    // timer queue has been changed - we have to restart the loop
+                    continue;
+                }
+                batch_end_time_point = nearest_time_point + _slack;
             }
+
+            run_work (guard, _wq_item_container->pop ());
         }
     }
 
-    bool work_queue::wq_item_find_and_remove_all (
-        lock_type & /*guard*/, const client_id_type client_id)
+    work_queue::immediate_works_type::iterator work_queue::find_immediate_work (
+        const work_queue::work_id_type work_id)
     {
-        auto is_client_predicate = [client_id](const record_type & r){
-            return (r.first.client_id == client_id);
-        };
-
-        container_type::iterator new_end =
-            std::remove_if (std::begin (_wq_item_container),
-                            std::end (_wq_item_container),
-                            is_client_predicate);
+        return std::find_if (
+            _immediate_works.begin (), _immediate_works.end (),
+            [work_id](const record_type & r) { return r.second == work_id; });
+    }
 
-        if (new_end != std::end (_wq_item_container))
-        {
-            _wq_item_container.erase (new_end, _wq_item_container.end ());
-            return true;
-        }
-        return false;
+    work_queue::immediate_works_type::const_iterator work_queue::find_immediate_work (
+        const work_queue::work_id_type work_id) const
+    {
+        return std::find_if (
+            _immediate_works.cbegin (), _immediate_works.cend (),
+            [work_id](const record_type & r) { return r.second == work_id; });
     }
 
     status_code work_queue::cancel_client_works (const work_queue::client_id_type client_id)
@@ -350,12 +802,32 @@ namespace mqmx
         if (_worker_stopped_flag)
             return ExitStatus::NotAllowed;
 
-        if (wq_item_find_and_remove_all (guard, client_id))
+        drain_inbox (guard);
+        bool found = false;
+        if (_wq_item_container->remove_client (client_id))
         {
-            make_heap_and_notify_worker (guard);
-            return ExitStatus::Success;
+            signal_container_change (guard);
+            found = true;
         }
-        return ExitStatus::NotFound;
+
+        auto new_end = std::remove_if (
+            _immediate_works.begin (), _immediate_works.end (),
+            [client_id](const record_type & r) { return r.first.client_id == client_id; });
+        if (new_end != _immediate_works.end ())
+        {
+            _immediate_works.erase (new_end, _immediate_works.end ());
+            found = true;
+        }
+
+        for (auto & running : _running)
+        {
+            if ((running.second.client_id == client_id) && !running.second.cancelled)
+            {
+                running.second.cancelled = true;
+                found = true;
+            }
+        }
+        return found ? ExitStatus::Success : ExitStatus::NotFound;
     }
 
     work_queue::client_id_type work_queue::get_client_id ()
@@ -375,6 +847,6 @@ namespace mqmx
 
     bool work_queue::is_container_empty (work_queue::lock_type & /*guard*/) const
     {
-        return _wq_item_container.empty ();
+        return _wq_item_container->empty ();
     }
 } /* namespace mqmx */
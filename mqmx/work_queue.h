@@ -1,9 +1,12 @@
 #pragma once
 
+#include <atomic>
 #include <vector>
+#include <deque>
 #include <memory>
 #include <thread>
 #include <functional>
+#include <unordered_map>
 
 #include <crs/mutex.h>
 #include <crs/condition_variable.h>
@@ -26,9 +29,27 @@ namespace mqmx
      * the places where waiting for some time point is performed. So derived
      * class might have a better control of the internal worker.
      *
+     * Works are executed by the internal worker itself, unless a pool of
+     * executor threads is requested at construction. In the latter case the
+     * worker only dispatches due works to executors, so a slow work doesn't
+     * delay other works. Works of the same client might be serialized (never
+     * executed concurrently) on request.
+     *
+     * Single works are scheduled without acquiring the main mutex: they are
+     * pushed into a lock-free inbox, which is drained into the internal
+     * container by the worker (and by any other call, which needs the
+     * actual content of the container).
+     *
+     * Works to be executed once and as soon as possible (scheduled with
+     * empty start time) are kept in a separate FIFO lane, which the worker
+     * services before the timers without reading the clock or waiting.
+     * Timers due are executed after every burst of immediate works, so
+     * they are not starved.
+     *
      * \note Very short timeout values (usually less than some milliseconds)
      *       cannot be guaranteed. Actual precision was not estimated and
-     *       depends on the system.
+     *       depends on the system (see timerfd_work_queue for better
+     *       precision on Linux).
      */
     class MQMX_EXPORT work_queue
     {
@@ -51,6 +72,55 @@ namespace mqmx
         static const client_id_type INVALID_CLIENT_ID; ///< invalid (unused) client ID
         static const work_id_type   INVALID_WORK_ID;   ///< invalid (unused) work ID
         static const duration_type  RUN_ONCE;          ///< empty (zero) period
+        static const duration_type  DEFAULT_TICK;      ///< default granularity of timer wheel
+        static const size_t         DEFAULT_IMMEDIATE_BURST; ///< default fairness bound of immediate works
+
+        /**
+         * \brief Engine keeping scheduled works ordered by their time points.
+         */
+        enum timer_engine
+        {
+            binary_heap = 0, /*!< O(log n) schedule and execution */
+            timer_wheel = 1  /*!< hierarchical timing wheel with O(1) schedule and
+                              *   cancel, suitable for a lot of works cancelled
+                              *   before execution
+                              */
+        };
+
+        /**
+         * \brief Rescheduling policy of periodic works.
+         */
+        enum periodic_policy
+        {
+            fixed_rate      = 0, /*!< next execution at previous time point + period,
+                                  *   missed executions are performed back-to-back
+                                  */
+            fixed_rate_skip = 1, /*!< the same as fixed_rate, but missed executions
+                                  *   are skipped (and counted)
+                                  */
+            fixed_delay     = 2  /*!< next execution at completion of the previous
+                                  *   one + period
+                                  */
+        };
+
+        /**
+         * \brief Description of single work for batch scheduling.
+         */
+        struct work_entry
+        {
+            work_pointer_type work;       ///< pointer to a work function
+            time_point_type   start_time; ///< first execution time point (empty means now)
+            duration_type     period;     ///< invocation repetition period or RUN_ONCE
+            periodic_policy   policy;     ///< rescheduling policy of periodic work
+
+            work_entry (const work_pointer_type & pwork,
+                        const time_point_type & tstart = time_point_type (),
+                        const duration_type & tperiod = RUN_ONCE,
+                        const periodic_policy tpolicy = fixed_rate);
+        };
+
+        typedef std::vector<work_entry>   work_entries_type;
+        typedef std::vector<work_id_type> work_ids_type;
 
     protected:
         /**
@@ -62,12 +132,15 @@ namespace mqmx
             client_id_type    client_id;  ///< ID of the work's owner
             work_pointer_type work;       ///< pointer to a work function
             duration_type     period;     ///< invocation repetition period
+            periodic_policy   policy;     ///< rescheduling policy
+            unsigned long     skipped;    ///< number of skipped executions
 
             wq_item ();
             wq_item (const time_point_type & tpoint,
                      const client_id_type clientid,
                      const work_pointer_type & pwork,
-                     const duration_type & tperiod);
+                     const duration_type & tperiod,
+                     const periodic_policy tpolicy = fixed_rate);
             wq_item (wq_item &&) = default;
             wq_item (const wq_item &) = default;
             wq_item & operator = (wq_item &&) = default;
@@ -90,6 +163,11 @@ namespace mqmx
             }
         };
 
+        /**
+         * \brief Storage of scheduled works (interface of timer engine).
+         */
+        class timer_storage;
+
         /**
          * \brief Data structure needed to call protected constructor.
          */
@@ -101,16 +179,97 @@ namespace mqmx
          * Initializes all internal data members but don't start internal
          * worker thread. This variant might be needed for derived classes
          * to avoid possible data race in accessing vtable.
+         *
+         * \param engine is the engine keeping scheduled works
+         * \param tick is the granularity of the timer wheel (ignored by other engines)
+         * \param nexecutors is the number of executor threads (zero means
+         *        works are executed by the worker itself)
+         * \param serialize_clients is the flag to never execute works of the
+         *        same client concurrently (ignored without executors)
          */
-        work_queue (const dont_start_worker);
+        work_queue (const dont_start_worker,
+                    const timer_engine engine = binary_heap,
+                    const duration_type & tick = DEFAULT_TICK,
+                    const size_t nexecutors = 0,
+                    const bool serialize_clients = false);
 
     public:
         /**
          * \brief Default constructor.
          *
          * Initializes all internal data members and starts internal worker thread.
+         *
+         * \param engine is the engine keeping scheduled works
+         * \param tick is the granularity of the timer wheel (ignored by other
+         *        engines), works scheduled within the same tick are still
+         *        executed in order of their time points
+         */
+        explicit work_queue (const timer_engine engine = binary_heap,
+                             const duration_type & tick = DEFAULT_TICK);
+
+        /**
+         * \brief Constructor of work queue with pool of executors.
+         *
+         * Internal worker thread only waits for time points of works and
+         * dispatches due works to the given number of executor threads.
+         * Periodic work is rescheduled after its execution is completed, so
+         * the same work is never executed concurrently.
+         *
+         * \param nexecutors is the number of executor threads
+         * \param serialize_clients is the flag to never execute works of the
+         *        same client concurrently; due works of a busy client are
+         *        executed in order of their time points after the running one
+         * \param engine is the engine keeping scheduled works
+         * \param tick is the granularity of the timer wheel (ignored by other engines)
+         */
+        work_queue (const size_t nexecutors,
+                    const bool serialize_clients,
+                    const timer_engine engine = binary_heap,
+                    const duration_type & tick = DEFAULT_TICK);
+
+        /**
+         * \brief Returns the number of executor threads (zero if works are
+         *        executed by the internal worker).
+         */
+        size_t get_executors_count () const;
+
+        /**
+         * \brief Set timer slack (tolerance) of the queue.
+         *
+         * When worker wakes up for the nearest work, it also executes all
+         * works due within the slack window after it, so works with close
+         * time points are executed together in single wake up instead of
+         * waking the worker for each of them. Works might be executed
+         * earlier than their time points by at most \a slack, periodic works
+         * are still rescheduled relative to their own time points.
+         *
+         * \param slack is the width of the window (zero by default, which
+         *        means no coalescing)
+         */
+        void set_slack (const duration_type & slack);
+
+        /**
+         * \brief Returns timer slack of the queue.
+         */
+        duration_type get_slack () const;
+
+        /**
+         * \brief Set fairness bound of immediate works.
+         *
+         * Worker executes at most \a burst immediate works in a row, then
+         * all timers due by that moment are executed before the next burst.
+         *
+         * \param burst is the maximum number of immediate works executed
+         *        without checking timers (DEFAULT_IMMEDIATE_BURST by default,
+         *        zero is the same as one - timers are checked before every
+         *        immediate work)
+         */
+        void set_immediate_burst (const size_t burst);
+
+        /**
+         * \brief Returns fairness bound of immediate works.
          */
-        work_queue ();
+        size_t get_immediate_burst () const;
 
         /**
          * \brief Destructor.
@@ -140,6 +299,13 @@ namespace mqmx
          * \param repeat_period is a timeout, that is used to periodically
          *        re-trigger work execution since first trigger (it can be set
          *        to RUN_ONCE if periodic triggering is not needed)
+         * \param policy is the rescheduling policy of periodic work
+         *
+         * \note Work with empty \a start_time and RUN_ONCE \a repeat_period is
+         *       put into the lane of immediate works.
+         *
+         * \note Main mutex is not acquired, unless the worker has to be woken
+         *       up, so concurrent scheduling doesn't block behind the worker.
          *
          * \retval ExitStatus::NotAllowed      if worker thread is terminated
          * \retval ExitStatus::InvalidArgument if work pointer is null
@@ -149,7 +315,27 @@ namespace mqmx
             const client_id_type client_id,
             const work_pointer_type & work,
             const time_point_type & start_time = time_point_type (),
-            const duration_type & repeat_period = RUN_ONCE);
+            const duration_type & repeat_period = RUN_ONCE,
+            const periodic_policy policy = fixed_rate);
+
+        /**
+         * \brief Schedule several works of the same client at once.
+         *
+         * All works are inserted under single lock with single fix-up of the
+         * internal container and single wake up of the worker, which is
+         * much cheaper than a sequence of schedule_work() calls.
+         *
+         * \param client_id is an ID of the works' owner
+         * \param works is the list of works to be scheduled
+         *
+         * \retval ExitStatus::NotAllowed      if worker thread is terminated
+         * \retval ExitStatus::InvalidArgument if any work pointer is null
+         *                                     (nothing is scheduled)
+         * \retval ExitStatus::Success         in case of success, IDs of works
+         *                                     are returned in order of \a works
+         */
+        std::pair<status_code, work_ids_type> schedule_works (
+            const client_id_type client_id, const work_entries_type & works);
 
         /**
          * \brief Update work with given ID.
@@ -167,6 +353,7 @@ namespace mqmx
          * \param repeat_period is a timeout, that is used to periodically
          *        re-trigger work execution since first trigger (it can be set
          *        to RUN_ONCE if periodic triggering is not needed)
+         * \param policy is the rescheduling policy of periodic work
          *
          * \retval ExitStatus::NotAllowed      if worker thread is terminated
          * \retval ExitStatus::InvalidArgument if work pointer is null
@@ -178,7 +365,22 @@ namespace mqmx
                                  const client_id_type client_id,
                                  const work_pointer_type & work,
                                  const time_point_type & start_time,
-                                 const duration_type & repeat_period);
+                                 const duration_type & repeat_period,
+                                 const periodic_policy policy = fixed_rate);
+
+        /**
+         * \brief Get number of skipped executions of periodic work.
+         *
+         * Executions are skipped only by works with fixed_rate_skip policy,
+         * when the worker falls behind. Counter is reset by update_work().
+         *
+         * \param work_id is the ID of already posted work
+         *
+         * \retval ExitStatus::NotFound if work with given ID is not in the queue
+         * \retval ExitStatus::Success  in case of success
+         */
+        std::pair<status_code, unsigned long> get_skipped_count (
+            const work_id_type work_id) const;
 
         /**
          * \brief Cancel work with given ID.
@@ -215,6 +417,9 @@ namespace mqmx
          * \returns time point of nearest work item to be executed or empty time
          *          point (set to epoch) if there are no events scheduled
          *
+         * \note Immediate works have no time point and are not taken into
+         *       account.
+         *
          * \note This method is in general needed for tests.
          */
         time_point_type get_nearest_time_point () const;
@@ -276,8 +481,13 @@ namespace mqmx
          *
          * After work execution this method checks conditions for work
          * rescheduling and calculates next time point, when this work should be
-         * executed once again. Usually next time point is calculated as
-         * <i>current-time-point + repeat-period</i>.
+         * executed once again. Next time point is calculated according to
+         * the work's policy, usually as <i>time-point + repeat-period</i>.
+         *
+         * User work is called with main mutex released, so other threads are
+         * not blocked for the time of its execution. Work might be cancelled
+         * or updated meanwhile (even by itself), such changes are applied
+         * after its completion.
          *
          * \param guard acquired lock for main mutex
          * \param record internal WQ item record
@@ -286,7 +496,8 @@ namespace mqmx
          *          or empty time point in case work rescheduling is not
          *          needed
          *
-         * \attention Method is called with main mutex acquired.
+         * \attention Method is called with main mutex acquired, except for
+         *            executor threads, which call it with \a guard released.
          */
         virtual time_point_type execute_work (
             lock_type & guard, const record_type & record);
@@ -335,34 +546,101 @@ namespace mqmx
          * so worker has to be restarted every time some change in intarnal
          * container happened.
          *
+         * Derived classes, which wait for time point by other means than
+         * main conditional variable, should also wake up their waiting.
+         *
          * \attention Method is called with main mutex acquired.
          */
-        void signal_container_change (lock_type & guard);
+        virtual void signal_container_change (lock_type & guard);
 
     private:
+        class heap_timer_storage;
+        class wheel_timer_storage;
+
         std::pair<status_code, work_id_type> post_work (lock_type &, wq_item);
         time_point_type get_empty_time_point () const;
 
         bool wait_for_some_work (lock_type &);
-        void make_heap_and_notify_worker (lock_type &);
-        bool wq_item_find_and_replace (
-            lock_type &, const work_id_type, const wq_item & new_item);
-        bool wq_item_find_and_remove (lock_type &, const work_id_type);
-        bool wq_item_find_and_remove_all (lock_type &, const client_id_type);
         bool signal_worker_to_stop ();
         void worker ();
 
-        work_id_type       _next_work_id;
-        client_id_type     _next_client_id;
+        /*
+         * State of a due work being executed (or dispatched to executors).
+         * Work is not in the storage until completed, so its cancellation
+         * and update are applied on completion.
+         */
+        struct running_state
+        {
+            client_id_type client_id;
+            bool           cancelled;
+            bool           updated;
+            wq_item        item;      /* replacement item if updated */
+            unsigned long  skipped;
+        };
+
+        typedef std::unordered_map<work_id_type, running_state>             running_map_type;
+        typedef std::unordered_map<client_id_type, std::deque<record_type>> clients_map_type;
+
+        typedef std::deque<record_type> immediate_works_type;
+
+        void run_work (lock_type &, record_type &&);
+        immediate_works_type::iterator find_immediate_work (const work_id_type);
+        immediate_works_type::const_iterator find_immediate_work (const work_id_type) const;
+        void dispatch_work (lock_type &, record_type &&);
+        void complete_work (lock_type &, record_type &&, const time_point_type &);
+        void executor ();
+        void stop_executors ();
+
+        /*
+         * Node of the inbox of scheduled works (intrusive lock-free LIFO
+         * list of records pushed by any thread and drained by the thread
+         * holding main mutex).
+         */
+        struct inbox_node
+        {
+            record_type  record;
+            inbox_node * next;
+        };
+
+        work_id_type get_next_work_id ();
+        bool push_to_inbox (inbox_node * node);
+        void drain_inbox (lock_type &);
+
+        /*
+         * Read-only inspection of the inbox for const observers. Nodes are
+         * released only by drain_inbox, so the list is stable while main
+         * mutex is held. Works scheduled after termination are not reported,
+         * since they are discarded on drain.
+         */
+        bool has_inbox_works (lock_type &) const;
+        const record_type * find_inbox_work (lock_type &, const work_id_type) const;
+        time_point_type get_inbox_nearest_time_point (lock_type &) const;
+
+        std::atomic<work_id_type> _next_work_id;
+        client_id_type            _next_client_id;
 
     protected:
         mutable mutex_type _mutex; ///< main mutex
         condvar_type       _container_change_condition; ///< main condition variable
 
     private:
-        container_type     _wq_item_container;
+        std::unique_ptr<timer_storage> _wq_item_container;
         bool               _container_change_flag;
-        bool               _worker_stopped_flag;
+        std::atomic<bool>  _worker_stopped_flag;
+        std::atomic<inbox_node *> _inbox; /* works not yet in the container */
         thread_type        _worker;
+
+        const size_t             _nexecutors;
+        const bool               _serialize_clients;
+        std::vector<thread_type> _executors;
+        condvar_type             _ready_condition;
+        std::deque<record_type>  _ready;        /* due works waiting for executor */
+        running_map_type         _running;      /* executed or dispatched, but not completed works */
+        clients_map_type         _busy_clients; /* clients with running work and their due works */
+        bool                     _executors_stop_flag;
+        duration_type            _slack;
+
+        immediate_works_type     _immediate_works; /* lane of immediate works */
+        size_t                   _immediate_burst;
     };
 } /* namespace mqmx */
@@ -0,0 +1,439 @@
+#include <mqmx/work_queue_storage.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace mqmx
+{
+    work_queue::heap_timer_storage::heap_timer_storage ()
+        : _records ()
+        , _positions ()
+    { }
+
+    bool work_queue::heap_timer_storage::is_earlier (
+        const record_type & a, const record_type & b)
+    {
+        return record_compare () (b, a);
+    }
+
+    void work_queue::heap_timer_storage::place (const size_t pos, record_type && record)
+    {
+        _positions[record.second] = pos;
+        _records[pos] = std::move (record);
+    }
+
+    void work_queue::heap_timer_storage::sift_up (size_t pos)
+    {
+        record_type record = std::move (_records[pos]);
+        while (pos > 0)
+        {
+            const size_t parent = (pos - 1) / 2;
+            if (!is_earlier (record, _records[parent]))
+                break;
+            place (pos, std::move (_records[parent]));
+            pos = parent;
+        }
+        place (pos, std::move (record));
+    }
+
+    void work_queue::heap_timer_storage::sift_down (size_t pos)
+    {
+        const size_t size = _records.size ();
+        record_type record = std::move (_records[pos]);
+        for (;;)
+        {
+            size_t child = 2 * pos + 1;
+            if (child >= size)
+                break;
+            if ((child + 1 < size) && is_earlier (_records[child + 1], _records[child]))
+                ++child;
+            if (!is_earlier (_records[child], record))
+                break;
+            place (pos, std::move (_records[child]));
+            pos = child;
+        }
+        place (pos, std::move (record));
+    }
+
+    void work_queue::heap_timer_storage::restore (const size_t pos)
+    {
+        if ((pos > 0) && is_earlier (_records[pos], _records[(pos - 1) / 2]))
+            sift_up (pos);
+        else
+            sift_down (pos);
+    }
+
+    void work_queue::heap_timer_storage::rebuild ()
+    {
+        std::make_heap (std::begin (_records), std::end (_records), record_compare ());
+        _positions.clear ();
+        for (size_t pos = 0; pos < _records.size (); ++pos)
+            _positions[_records[pos].second] = pos;
+    }
+
+    work_queue::heap_timer_storage::record_type
+    work_queue::heap_timer_storage::extract (const size_t pos)
+    {
+        record_type record = std::move (_records[pos]);
+        _positions.erase (record.second);
+
+        const size_t last = _records.size () - 1;
+        if (pos != last)
+        {
+            place (pos, std::move (_records[last]));
+            _records.pop_back ();
+            restore (pos);
+        }
+        else
+            _records.pop_back ();
+        return record;
+    }
+
+    bool work_queue::heap_timer_storage::empty () const
+    {
+        return _records.empty ();
+    }
+
+    void work_queue::heap_timer_storage::clear ()
+    {
+        _records.clear ();
+        _positions.clear ();
+    }
+
+    void work_queue::heap_timer_storage::insert (record_type && record)
+    {
+        _records.emplace_back ();
+        place (_records.size () - 1, std::move (record));
+        sift_up (_records.size () - 1);
+    }
+
+    void work_queue::heap_timer_storage::insert (std::vector<record_type> && records)
+    {
+        /* rebuilding of the whole heap is O(n), so it's cheaper than
+         * sifting of each record, when a lot of records are added */
+        if (records.size () * 4 < _records.size ())
+        {
+            for (auto & record : records)
+                insert (std::move (record));
+            return;
+        }
+
+        _records.reserve (_records.size () + records.size ());
+        std::move (std::begin (records), std::end (records), std::back_inserter (_records));
+        rebuild ();
+    }
+
+    bool work_queue::heap_timer_storage::replace (const work_id_type work_id, const wq_item & item)
+    {
+        auto it = _positions.find (work_id);
+        if (it == _positions.end ())
+            return false;
+
+        const size_t pos = it->second;
+        _records[pos].first = item;
+        restore (pos);
+        return true;
+    }
+
+    bool work_queue::heap_timer_storage::remove (const work_id_type work_id)
+    {
+        auto it = _positions.find (work_id);
+        if (it == _positions.end ())
+            return false;
+
+        extract (it->second);
+        return true;
+    }
+
+    const work_queue::heap_timer_storage::record_type *
+    work_queue::heap_timer_storage::find (const work_id_type work_id) const
+    {
+        auto it = _positions.find (work_id);
+        return (it != _positions.end ()) ? &_records[it->second] : nullptr;
+    }
+
+    bool work_queue::heap_timer_storage::remove_client (const client_id_type client_id)
+    {
+        auto is_client_predicate = [client_id](const record_type & r){
+            return (r.first.client_id == client_id);
+        };
+
+        container_type::iterator new_end =
+            std::remove_if (std::begin (_records), std::end (_records), is_client_predicate);
+
+        if (new_end != std::end (_records))
+        {
+            /* bulk removal - cheaper to rebuild the heap and the index at once */
+            _records.erase (new_end, _records.end ());
+            rebuild ();
+            return true;
+        }
+        return false;
+    }
+
+    const work_queue::heap_timer_storage::record_type & work_queue::heap_timer_storage::top ()
+    {
+        return _records.front ();
+    }
+
+    work_queue::heap_timer_storage::record_type work_queue::heap_timer_storage::pop ()
+    {
+        return extract (0);
+    }
+
+    namespace
+    {
+        /* index of the first set bit starting from position 'from' or 'nbits' if none */
+        size_t find_first_set (const uint64_t * words, const size_t nbits, const size_t from)
+        {
+            const size_t word_bits = 64;
+            for (size_t pos = from; pos < nbits; pos = (pos / word_bits + 1) * word_bits)
+            {
+                const uint64_t word = words[pos / word_bits] >> (pos % word_bits);
+                if (word)
+                {
+#if defined(__GNUC__)
+                    return pos + static_cast<size_t> (__builtin_ctzll (word));
+#else
+                    size_t bit = 0;
+                    while (!((word >> bit) & 1))
+                        ++bit;
+                    return pos + bit;
+#endif
+                }
+            }
+            return nbits;
+        }
+    } /* namespace */
+
+    work_queue::wheel_timer_storage::wheel_timer_storage (const work_queue::duration_type & tick)
+        : _tick ((tick.count () > 0) ? tick : work_queue::DEFAULT_TICK)
+        , _now (0)
+        , _nodes ()
+        , _overflow (nullptr)
+        , _top (nullptr)
+    {
+        std::memset (_slots, 0, sizeof (_slots));
+        std::memset (_occupied, 0, sizeof (_occupied));
+    }
+
+    uint64_t work_queue::wheel_timer_storage::to_tick (
+        const work_queue::time_point_type & time_point) const
+    {
+        const auto since_epoch = time_point.time_since_epoch ();
+        if (since_epoch.count () <= 0)
+            return 0;
+        return static_cast<uint64_t> (since_epoch / _tick);
+    }
+
+    void work_queue::wheel_timer_storage::link (node & n)
+    {
+        /* records from the past are due right now */
+        if (n.tick < _now)
+            n.tick = _now;
+
+        n.head = &_overflow;
+        for (size_t level = 0; level < LEVELS; ++level)
+        {
+            const size_t shift = SLOT_BITS * (level + 1);
+            if ((n.tick >> shift) == (_now >> shift))
+            {
+                const size_t index = (n.tick >> (SLOT_BITS * level)) & (SLOTS - 1);
+                n.head = &_slots[level][index];
+                _occupied[level][index / WORD_BITS] |= uint64_t (1) << (index % WORD_BITS);
+                break;
+            }
+        }
+
+        n.prev = nullptr;
+        n.next = *n.head;
+        if (n.next)
+            n.next->prev = &n;
+        *n.head = &n;
+    }
+
+    void work_queue::wheel_timer_storage::unlink (node & n)
+    {
+        if (n.prev)
+            n.prev->next = n.next;
+        else
+            *n.head = n.next;
+        if (n.next)
+            n.next->prev = n.prev;
+
+        if (!*n.head && (n.head != &_overflow))
+        {
+            const size_t offset = static_cast<size_t> (n.head - &_slots[0][0]);
+            const size_t index = offset % SLOTS;
+            _occupied[offset / SLOTS][index / WORD_BITS] &= ~(uint64_t (1) << (index % WORD_BITS));
+        }
+        n.prev = n.next = nullptr;
+        n.head = nullptr;
+    }
+
+    void work_queue::wheel_timer_storage::relink_list (node * head)
+    {
+        while (head)
+        {
+            node * const next = head->next;
+            unlink (*head);
+            link (*head);
+            head = next;
+        }
+    }
+
+    void work_queue::wheel_timer_storage::advance (const uint64_t tick)
+    {
+        if (tick <= _now)
+            return;
+
+        const uint64_t old = _now;
+        _now = tick;
+
+        /* records are never earlier than the new position, so only the slots
+         * (and overflow) the position moved into need to be cascaded down */
+        const size_t wheel_bits = SLOT_BITS * LEVELS;
+        if ((old >> wheel_bits) != (_now >> wheel_bits))
+            relink_list (_overflow);
+
+        for (size_t level = LEVELS - 1; level > 0; --level)
+        {
+            const size_t shift = SLOT_BITS * level;
+            if ((old >> shift) != (_now >> shift))
+                relink_list (_slots[level][(_now >> shift) & (SLOTS - 1)]);
+        }
+    }
+
+    work_queue::wheel_timer_storage::node * work_queue::wheel_timer_storage::find_top ()
+    {
+        node * head = _overflow;
+        for (size_t level = 0; level < LEVELS; ++level)
+        {
+            const size_t from = (_now >> (SLOT_BITS * level)) & (SLOTS - 1);
+            const size_t index = find_first_set (_occupied[level], SLOTS, from);
+            if (index < SLOTS)
+            {
+                head = _slots[level][index];
+                break;
+            }
+        }
+
+        /* ticks are coarse, so the exact time points are compared within the slot;
+         * ties are broken by work ID to keep order of scheduling */
+        node * top = head;
+        for (node * n = head; n; n = n->next)
+        {
+            if ((n->record.first.time_point < top->record.first.time_point) ||
+                ((n->record.first.time_point == top->record.first.time_point) &&
+                 (n->record.second < top->record.second)))
+            {
+                top = n;
+            }
+        }
+        return top;
+    }
+
+    bool work_queue::wheel_timer_storage::empty () const
+    {
+        return _nodes.empty ();
+    }
+
+    void work_queue::wheel_timer_storage::clear ()
+    {
+        _nodes.clear ();
+        std::memset (_slots, 0, sizeof (_slots));
+        std::memset (_occupied, 0, sizeof (_occupied));
+        _overflow = nullptr;
+        _top = nullptr;
+    }
+
+    void work_queue::wheel_timer_storage::insert (record_type && record)
+    {
+        const work_id_type work_id = record.second;
+        const uint64_t tick = to_tick (record.first.time_point);
+        node & n = _nodes.emplace (
+            work_id, node {std::move (record), tick, nullptr, nullptr, nullptr}).first->second;
+        link (n);
+
+        if (_top && (n.record.first.time_point < _top->record.first.time_point))
+            _top = &n;
+    }
+
+    bool work_queue::wheel_timer_storage::replace (const work_id_type work_id, const wq_item & item)
+    {
+        auto it = _nodes.find (work_id);
+        if (it == _nodes.end ())
+            return false;
+
+        node & n = it->second;
+        unlink (n);
+        n.record.first = item;
+        n.tick = to_tick (item.time_point);
+        link (n);
+        _top = nullptr;
+        return true;
+    }
+
+    bool work_queue::wheel_timer_storage::remove (const work_id_type work_id)
+    {
+        auto it = _nodes.find (work_id);
+        if (it == _nodes.end ())
+            return false;
+
+        if (_top == &it->second)
+            _top = nullptr;
+        unlink (it->second);
+        _nodes.erase (it);
+        return true;
+    }
+
+    const work_queue::wheel_timer_storage::record_type *
+    work_queue::wheel_timer_storage::find (const work_id_type work_id) const
+    {
+        auto it = _nodes.find (work_id);
+        return (it != _nodes.end ()) ? &it->second.record : nullptr;
+    }
+
+    bool work_queue::wheel_timer_storage::remove_client (const client_id_type client_id)
+    {
+        bool removed = false;
+        for (auto it = _nodes.begin (); it != _nodes.end (); )
+        {
+            if (it->second.record.first.client_id == client_id)
+            {
+                unlink (it->second);
+                it = _nodes.erase (it);
+                removed = true;
+            }
+            else
+                ++it;
+        }
+        if (removed)
+            _top = nullptr;
+        return removed;
+    }
+
+    const work_queue::wheel_timer_storage::record_type & work_queue::wheel_timer_storage::top ()
+    {
+        if (!_top)
+            _top = find_top ();
+        return _top->record;
+    }
+
+    work_queue::wheel_timer_storage::record_type work_queue::wheel_timer_storage::pop ()
+    {
+        if (!_top)
+            _top = find_top ();
+
+        node & n = *_top;
+        _top = nullptr;
+        advance (n.tick);
+
+        const work_id_type work_id = n.record.second;
+        record_type record = std::move (n.record);
+        unlink (n);
+        _nodes.erase (work_id);
+        return record;
+    }
+} /* namespace mqmx */
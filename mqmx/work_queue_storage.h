@@ -0,0 +1,192 @@
+#pragma once
+
+#include <mqmx/work_queue.h>
+
+#include <cstdint>
+#include <unordered_map>
+
+namespace mqmx
+{
+    /**
+     * \brief Storage of scheduled works (interface of timer engine).
+     *
+     * Keeps work records and provides the record with the earliest time
+     * point. All methods are called with main mutex of work queue acquired.
+     */
+    class work_queue::timer_storage
+    {
+    public:
+        typedef work_queue::wq_item        wq_item;
+        typedef work_queue::record_type    record_type;
+        typedef work_queue::work_id_type   work_id_type;
+        typedef work_queue::client_id_type client_id_type;
+        typedef work_queue::record_compare record_compare;
+
+        virtual ~timer_storage () { }
+
+        /**
+         * \brief Checks whether storage has no records.
+         */
+        virtual bool empty () const = 0;
+
+        /**
+         * \brief Removes all records.
+         */
+        virtual void clear () = 0;
+
+        /**
+         * \brief Adds new record.
+         */
+        virtual void insert (record_type && record) = 0;
+
+        /**
+         * \brief Adds several records at once.
+         */
+        virtual void insert (std::vector<record_type> && records)
+        {
+            for (auto & record : records)
+                insert (std::move (record));
+        }
+
+        /**
+         * \brief Replaces item of record with given work ID.
+         *
+         * \returns false if there is no such record
+         */
+        virtual bool replace (const work_id_type work_id, const wq_item & item) = 0;
+
+        /**
+         * \brief Removes record with given work ID.
+         *
+         * \returns false if there is no such record
+         */
+        virtual bool remove (const work_id_type work_id) = 0;
+
+        /**
+         * \brief Returns record with given work ID or nullptr.
+         */
+        virtual const record_type * find (const work_id_type work_id) const = 0;
+
+        /**
+         * \brief Removes all records of given client.
+         *
+         * \returns false if there are no such records
+         */
+        virtual bool remove_client (const client_id_type client_id) = 0;
+
+        /**
+         * \brief Returns record with the earliest time point.
+         *
+         * \attention Storage should not be empty.
+         */
+        virtual const record_type & top () = 0;
+
+        /**
+         * \brief Removes and returns record with the earliest time point.
+         *
+         * \attention Storage should not be empty.
+         */
+        virtual record_type pop () = 0;
+    };
+
+    /*
+     * Binary heap of records (original engine of work queue).
+     *
+     * Heap position of every record is indexed by its work ID and kept up to
+     * date on every sift, so records are cancelled and updated in O(log n)
+     * without full rebuild of the heap.
+     */
+    class work_queue::heap_timer_storage final : public work_queue::timer_storage
+    {
+        typedef std::vector<record_type>                    container_type;
+        typedef std::unordered_map<work_id_type, size_t>    positions_map_type;
+
+        container_type     _records;
+        positions_map_type _positions; /* work ID -> index in _records */
+
+        static bool is_earlier (const record_type & a, const record_type & b);
+        void place (const size_t pos, record_type && record);
+        void sift_up (size_t pos);
+        void sift_down (size_t pos);
+        void restore (const size_t pos);
+        void rebuild ();
+        record_type extract (const size_t pos);
+
+    public:
+        heap_timer_storage ();
+
+        virtual bool empty () const override;
+        virtual void clear () override;
+        virtual void insert (record_type && record) override;
+        virtual void insert (std::vector<record_type> && records) override;
+        virtual bool replace (const work_id_type work_id, const wq_item & item) override;
+        virtual bool remove (const work_id_type work_id) override;
+        virtual const record_type * find (const work_id_type work_id) const override;
+        virtual bool remove_client (const client_id_type client_id) override;
+        virtual const record_type & top () override;
+        virtual record_type pop () override;
+    };
+
+    /*
+     * Hierarchical timing wheel.
+     *
+     * Time is divided into ticks. Each of LEVELS levels has SLOTS slots, a slot
+     * of level L covers SLOTS^L ticks. Record is linked into the slot of the
+     * lowest level, which range of the current position of the wheel covers
+     * the record's tick. Records too far in the future are kept in overflow
+     * list. Insertion and removal are O(1), records are cascaded down to the
+     * lower levels as the wheel advances (only when the earliest record is
+     * popped).
+     *
+     * Earliest record is the earliest one (by exact time point) in the first
+     * occupied slot, it is cached until removed.
+     */
+    class work_queue::wheel_timer_storage final : public work_queue::timer_storage
+    {
+        static const size_t SLOT_BITS = 8;
+        static const size_t SLOTS = size_t (1) << SLOT_BITS;
+        static const size_t LEVELS = 4;
+        static const size_t WORD_BITS = 64;
+
+        struct node
+        {
+            record_type record;
+            uint64_t    tick;
+            node *      prev;
+            node *      next;
+            node **     head;
+        };
+
+        typedef std::unordered_map<work_id_type, node> nodes_map_type;
+
+        const work_queue::duration_type _tick;
+        uint64_t                        _now;    /* current position of the wheel */
+        nodes_map_type                  _nodes;  /* owns nodes, addresses are stable */
+        node *                          _slots[LEVELS][SLOTS];
+        uint64_t                        _occupied[LEVELS][SLOTS / WORD_BITS];
+        node *                          _overflow;
+        node *                          _top;    /* cached earliest node */
+
+        uint64_t to_tick (const work_queue::time_point_type & time_point) const;
+        void link (node & n);
+        void unlink (node & n);
+        void relink_list (node * head);
+        void advance (const uint64_t tick);
+        node * find_top ();
+
+    public:
+        explicit wheel_timer_storage (const work_queue::duration_type & tick);
+
+        using timer_storage::insert;
+
+        virtual bool empty () const override;
+        virtual void clear () override;
+        virtual void insert (record_type && record) override;
+        virtual bool replace (const work_id_type work_id, const wq_item & item) override;
+        virtual bool remove (const work_id_type work_id) override;
+        virtual const record_type * find (const work_id_type work_id) const override;
+        virtual bool remove_client (const client_id_type client_id) override;
+        virtual const record_type & top () override;
+        virtual record_type pop () override;
+    };
+} /* namespace mqmx */
@@ -0,0 +1,306 @@
+#include "mqmx/bounded_message_queue.h"
+#include "mqmx/message_queue_poll.h"
+#include "mqmx/message_queue_pool.h"
+#include <crs/semaphore.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#undef NDEBUG
+#include <cassert>
+
+namespace
+{
+    struct blob_message : mqmx::message
+    {
+        std::vector<char> data;
+
+        blob_message (const mqmx::queue_id_type qid,
+                      const mqmx::message_id_type mid,
+                      const size_t size)
+            : mqmx::message (qid, mid)
+            , data (size)
+        { }
+    };
+} /* namespace */
+
+int main ()
+{
+    {
+        /*
+         * sanity checks
+         */
+        using namespace mqmx;
+        const queue_id_type defQID = 10;
+
+        bounded_message_queue queue (defQID, 2);
+        assert (2 == queue.get_max_messages ());
+        assert (0 == queue.get_max_bytes ());
+        assert (bounded_message_queue::reject == queue.get_policy ());
+        assert (nullptr == queue.pop ().get ());
+
+        status_code retCode = queue.push (nullptr);
+        assert (ExitStatus::InvalidArgument == retCode);
+
+        {
+            message_queue queue2 (defQID + 1);
+            retCode = queue.push (queue2.new_message<message> (defQID));
+            assert (ExitStatus::NotSupported == retCode);
+        }
+
+        assert (ExitStatus::InvalidArgument == queue.set_watermarks (2, 2));
+        assert (ExitStatus::Success == queue.set_watermarks (0, 0));
+    }
+    {
+        /*
+         * message, which doesn't fit, is rejected and left to the caller
+         */
+        using namespace mqmx;
+        const queue_id_type defQID = 10;
+
+        bounded_message_queue queue (defQID, 2);
+        assert (ExitStatus::Success == queue.enqueue<message> (0));
+        assert (ExitStatus::Success == queue.enqueue<message> (1));
+        assert (2 == queue.get_size ());
+
+        message::upointer_type msg (queue.new_message<message> (2));
+        assert (ExitStatus::Overflow == queue.try_push (std::move (msg)));
+        assert (nullptr != msg.get ());
+        assert (1 == queue.get_rejected_count ());
+
+        /* waiting without timeout is the same as try_push */
+        assert (ExitStatus::Timeout == queue.push (std::move (msg), wait_time_provider ()));
+        assert (ExitStatus::Timeout == queue.push (std::move (msg), std::chrono::milliseconds (10)));
+        assert (nullptr != msg.get ());
+        assert (3 == queue.get_rejected_count ());
+
+        /* batch is rejected as a whole */
+        message_queue::container_type batch;
+        batch.push_back (queue.new_message<message> (3));
+        assert (ExitStatus::Overflow == queue.push_batch (batch));
+        assert (1 == batch.size ());
+
+        assert (0 == queue.pop ()->get_mid ());
+        assert (ExitStatus::Success == queue.try_push (std::move (msg)));
+        assert (1 == queue.pop ()->get_mid ());
+        assert (2 == queue.pop ()->get_mid ());
+        assert (0 == queue.get_dropped_count ());
+    }
+    {
+        /*
+         * blocked producer is released when consumer frees the space
+         */
+        using namespace mqmx;
+        const queue_id_type defQID = 10;
+
+        bounded_message_queue queue (defQID, 1);
+        assert (ExitStatus::Success == queue.enqueue<message> (0));
+
+        std::thread producer ([&queue]{
+                const status_code retCode = queue.push (
+                    queue.new_message<message> (1), wait_time_provider::WAIT_INFINITELY);
+                assert (ExitStatus::Success == retCode);
+            });
+
+        std::this_thread::sleep_for (std::chrono::milliseconds (10));
+        assert (0 == queue.pop ()->get_mid ());
+        producer.join ();
+
+        assert (1 == queue.get_size ());
+        assert (1 == queue.pop ()->get_mid ());
+    }
+    {
+        /*
+         * shedding policies
+         */
+        using namespace mqmx;
+        const queue_id_type defQID = 10;
+
+        bounded_message_queue oldest (defQID, 3, bounded_message_queue::drop_oldest);
+        bounded_message_queue newest (defQID, 3, bounded_message_queue::drop_newest);
+        for (message_id_type mid = 0; mid < 5; ++mid)
+        {
+            assert (ExitStatus::Success == oldest.enqueue<message> (mid));
+            assert (ExitStatus::Success == newest.enqueue<message> (mid));
+        }
+        assert (3 == oldest.get_size ());
+        assert (3 == newest.get_size ());
+        assert (2 == oldest.get_dropped_count ());
+        assert (2 == newest.get_dropped_count ());
+
+        auto mqlist = oldest.pop_all ();
+        assert (3 == mqlist.size ());
+        assert (2 == mqlist.front ()->get_mid ());
+        assert (4 == mqlist.back ()->get_mid ());
+
+        mqlist = newest.pop_all ();
+        assert (3 == mqlist.size ());
+        assert (0 == mqlist.front ()->get_mid ());
+        assert (2 == mqlist.back ()->get_mid ());
+
+        /* messages of the batch are dropped one by one */
+        message_queue::container_type batch;
+        for (message_id_type mid = 0; mid < 4; ++mid)
+        {
+            batch.push_back (oldest.new_message<message> (mid));
+        }
+        assert (ExitStatus::Success == oldest.push_batch (batch));
+        assert (batch.empty ());
+        assert (3 == oldest.get_size ());
+        assert (3 == oldest.get_dropped_count ());
+        assert (1 == oldest.pop ()->get_mid ());
+    }
+    {
+        /*
+         * capacity in bytes
+         */
+        using namespace mqmx;
+        const queue_id_type defQID = 10;
+        const auto size_of = [](const message & msg)
+            {
+                return static_cast<const blob_message &> (msg).data.size ();
+            };
+        bounded_message_queue queue (defQID, 0, bounded_message_queue::reject, 100, size_of);
+        assert (100 == queue.get_max_bytes ());
+
+        /* single message is always accepted by the empty queue */
+        assert (ExitStatus::Success == queue.enqueue<blob_message> (0, size_t (150)));
+        assert (150 == queue.get_bytes ());
+        assert (ExitStatus::Overflow == queue.enqueue<blob_message> (1, size_t (1)));
+        queue.pop ();
+        assert (0 == queue.get_bytes ());
+
+        assert (ExitStatus::Success == queue.enqueue<blob_message> (2, size_t (60)));
+        assert (ExitStatus::Success == queue.enqueue<blob_message> (3, size_t (40)));
+        assert (ExitStatus::Overflow == queue.enqueue<blob_message> (4, size_t (1)));
+        assert (100 == queue.get_bytes ());
+        assert (2 == queue.get_size ());
+    }
+    {
+        /*
+         * watermark notifications
+         */
+        using namespace mqmx;
+        const queue_id_type defQID = 10;
+
+        bounded_message_queue queue (defQID, 10);
+        assert (ExitStatus::Success == queue.set_watermarks (4, 1));
+
+        message_queue_poll_listener listener;
+        queue.set_listener (listener);
+        message_queue_poll_listener::notifications_list_type mqlist;
+
+        for (message_id_type mid = 0; mid < 3; ++mid)
+        {
+            queue.enqueue<message> (mid);
+        }
+        listener.take_notifications (mqlist);
+        assert (1 == mqlist.size ());
+        assert (message_queue::notification_flag::data == mqlist.front ().get_flags ());
+
+        queue.enqueue<message> (3);
+        queue.enqueue<message> (4);
+        listener.take_notifications (mqlist);
+        assert (1 == mqlist.size ());
+        assert (message_queue::notification_flag::high_watermark == mqlist.front ().get_flags ());
+
+        /* reported once until low watermark is reached */
+        queue.pop ();
+        queue.pop ();
+        queue.enqueue<message> (5);
+        listener.take_notifications (mqlist);
+        assert (mqlist.empty ());
+
+        message_queue::container_type out;
+        assert (3 == queue.drain (out, 3));
+        listener.take_notifications (mqlist);
+        assert (1 == mqlist.size ());
+        assert (message_queue::notification_flag::low_watermark == mqlist.front ().get_flags ());
+
+        queue.clear_listener ();
+    }
+    {
+        /*
+         * bounded queue as a backend of message queue pool
+         */
+        using namespace mqmx;
+        const size_t NMSGS = 1000;
+
+        message_queue_pool pool;
+        crs::semaphore sem;
+        size_t counter = 0;
+        auto queue = pool.allocate_queue<bounded_message_queue> (
+            [&](message::upointer_type && msg)
+            {
+                assert (counter == msg->get_mid ());
+                if (++counter == NMSGS)
+                {
+                    sem.post ();
+                }
+                return ExitStatus::Success;
+            }, 16);
+        assert (nullptr != queue.get ());
+
+        bounded_message_queue & bounded = static_cast<bounded_message_queue &> (*queue);
+        for (message_id_type mid = 0; mid < NMSGS; ++mid)
+        {
+            const status_code retCode = bounded.push (
+                bounded.new_message<message> (mid), wait_time_provider::WAIT_INFINITELY);
+            assert (ExitStatus::Success == retCode);
+            assert (bounded.get_size () <= 16);
+        }
+        sem.wait ();
+        assert (0 == bounded.get_rejected_count ());
+        assert (pool.is_poll_idle ());
+    }
+    {
+        /*
+         * slow handler of message queue pool makes producers wait
+         */
+        using namespace mqmx;
+        const size_t CAPACITY = 4;
+
+        message_queue_pool pool;
+        crs::semaphore started;
+        crs::semaphore gate;
+        crs::semaphore done;
+        size_t counter = 0;
+        auto queue = pool.allocate_queue<bounded_message_queue> (
+            [&](message::upointer_type &&)
+            {
+                if (counter++ == 0)
+                {
+                    started.post ();
+                    gate.wait ();
+                }
+                if (counter == CAPACITY + 1)
+                {
+                    done.post ();
+                }
+                return ExitStatus::Success;
+            }, CAPACITY);
+        assert (nullptr != queue.get ());
+        bounded_message_queue & bounded = static_cast<bounded_message_queue &> (*queue);
+
+        for (message_id_type mid = 0; mid < CAPACITY; ++mid)
+        {
+            assert (ExitStatus::Success == bounded.try_push (bounded.new_message<message> (mid)));
+        }
+
+        /* handler holds the first message, the rest stay in the queue */
+        started.wait ();
+        assert (CAPACITY - 1 == bounded.get_size ());
+        assert (ExitStatus::Success == bounded.try_push (bounded.new_message<message> (CAPACITY)));
+        assert (ExitStatus::Overflow == bounded.try_push (bounded.new_message<message> (0)));
+        assert (ExitStatus::Timeout == bounded.push (bounded.new_message<message> (0),
+                                                     std::chrono::milliseconds (10)));
+        assert (2 == bounded.get_rejected_count ());
+
+        gate.post ();
+        done.wait ();
+        assert (pool.is_poll_idle ());
+        assert (0 == bounded.get_size ());
+    }
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include "mqmx/eventfd_poll_listener.h"
+
+#include <thread>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
+
+#undef NDEBUG
+#include <cassert>
+
+#if defined(__linux__)
+namespace
+{
+    bool is_readable (const int epfd, const int timeout_ms = 0)
+    {
+        epoll_event event;
+        return (1 == epoll_wait (epfd, &event, 1, timeout_ms));
+    }
+}
+#endif
+
+int main ()
+{
+#if defined(__linux__)
+    const mqmx::message_id_type defmid = 10;
+    {
+        /*
+         * descriptor is readable while notifications are not taken out
+         */
+        mqmx::eventfd_poll_listener listener;
+        assert (mqmx::message_queue_poll_listener::ready_list == listener.get_mode ());
+        assert (0 <= listener.get_fd ());
+
+        const int epfd = epoll_create1 (0);
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        assert (0 == epoll_ctl (epfd, EPOLL_CTL_ADD, listener.get_fd (), &event));
+
+        mqmx::message_queue aqueue (1);
+        mqmx::message_queue bqueue (2);
+        aqueue.set_listener (listener);
+        bqueue.set_listener (listener);
+        assert (!is_readable (epfd));
+
+        aqueue.enqueue<mqmx::message> (defmid);
+        bqueue.enqueue<mqmx::message> (defmid);
+        aqueue.enqueue<mqmx::message> (defmid);
+        assert (is_readable (epfd));
+        assert (is_readable (epfd));
+
+        mqmx::message_queue_poll_listener::notifications_list_type mqlist;
+        listener.take_notifications (mqlist);
+        assert (2 == mqlist.size ());
+        assert (!is_readable (epfd));
+
+        /* reactor drains notified queues */
+        size_t count = 0;
+        for (auto & rec : mqlist)
+        {
+            while (rec.get_mq ()->pop ())
+                ++count;
+        }
+        assert (3 == count);
+
+        /* taking empty list doesn't change anything */
+        listener.take_notifications (mqlist);
+        assert (mqlist.empty ());
+        assert (!is_readable (epfd));
+
+        /* message pushed from another thread wakes up waiting reactor */
+        std::thread producer ([&bqueue, defmid]{
+                bqueue.enqueue<mqmx::message> (defmid);
+            });
+        assert (is_readable (epfd, 1000));
+        producer.join ();
+
+        listener.take_notifications (mqlist);
+        assert (1 == mqlist.size ());
+        assert (2 == mqlist[0].get_qid ());
+        assert (mqmx::message_queue::data == mqlist[0].get_flags ());
+        assert (!is_readable (epfd));
+
+        aqueue.clear_listener ();
+        bqueue.clear_listener ();
+        close (epfd);
+    }
+    {
+        /*
+         * other notifications make descriptor readable too (sorted list mode)
+         */
+        mqmx::eventfd_poll_listener listener (mqmx::message_queue_poll_listener::sorted_list);
+        const int epfd = epoll_create1 (0);
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        assert (0 == epoll_ctl (epfd, EPOLL_CTL_ADD, listener.get_fd (), &event));
+        {
+            mqmx::message_queue aqueue (7);
+            aqueue.set_listener (listener);
+            assert (!is_readable (epfd));
+        }
+        assert (is_readable (epfd));
+
+        mqmx::message_queue_poll_listener::notifications_list_type mqlist;
+        listener.wait_and_take_notifications (mqlist,
+                                              mqmx::wait_time_provider (),
+                                              mqmx::wait_time_provider ());
+        assert (1 == mqlist.size ());
+        assert (mqmx::message_queue::closed == mqlist[0].get_flags ());
+        assert (!is_readable (epfd));
+        close (epfd);
+    }
+#endif
+    return 0;
+}
@@ -0,0 +1,215 @@
+#include "mqmx/message_allocator.h"
+#include "mqmx/mpsc_message_queue.h"
+
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#undef NDEBUG
+#include <cassert>
+
+namespace
+{
+    template <size_t N>
+    struct payload_message : mqmx::message
+    {
+        unsigned char payload[N];
+
+        payload_message (const mqmx::queue_id_type qid, const mqmx::message_id_type mid)
+            : mqmx::message (qid, mid)
+        {
+            for (size_t ix = 0; ix < N; ++ix)
+            {
+                payload[ix] = static_cast<unsigned char> (mid + ix);
+            }
+        }
+
+        bool is_valid () const
+        {
+            for (size_t ix = 0; ix < N; ++ix)
+            {
+                if (payload[ix] != static_cast<unsigned char> (get_mid () + ix))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    struct alignas (64) aligned_message : mqmx::message
+    {
+        char payload[8];
+
+        aligned_message (const mqmx::queue_id_type qid, const mqmx::message_id_type mid)
+            : mqmx::message (qid, mid)
+        { }
+    };
+
+    struct throwing_message : mqmx::message
+    {
+        throwing_message (const mqmx::queue_id_type qid, const mqmx::message_id_type mid)
+            : mqmx::message (qid, mid)
+        {
+            throw std::runtime_error ("construction failed");
+        }
+    };
+
+    bool is_aligned (const void * ptr, const size_t alignment)
+    {
+        return reinterpret_cast<uintptr_t> (ptr) % alignment == 0;
+    }
+}
+
+int main ()
+{
+    using namespace mqmx;
+    const queue_id_type defQID = 10;
+    {
+        /*
+         * sanity checks
+         */
+        void * ptr = message_allocator::allocate (1);
+        assert (nullptr != ptr);
+        message_allocator::deallocate (ptr, 1);
+
+        /* blocks are reused */
+        void * ptr2 = message_allocator::allocate (1);
+        assert (ptr == ptr2);
+        message_allocator::deallocate (ptr2, 1);
+
+        ptr = message_allocator::allocate (message_allocator::MAX_BLOCK_SIZE + 1);
+        assert (nullptr != ptr);
+        message_allocator::deallocate (ptr, message_allocator::MAX_BLOCK_SIZE + 1);
+        message_allocator::deallocate (nullptr, 1);
+
+        /* size of the block is looked up by its address */
+        ptr = message_allocator::allocate (40);
+        assert (64 == message_allocator::get_block_size (ptr));
+        message_allocator::deallocate (ptr);
+        assert (ptr == message_allocator::allocate (64));
+        message_allocator::deallocate (ptr, 64);
+
+        ptr = message_allocator::allocate (message_allocator::MAX_BLOCK_SIZE + 1);
+        assert (0 == message_allocator::get_block_size (ptr));
+        message_allocator::deallocate (ptr);
+        message_allocator::deallocate (nullptr);
+    }
+    {
+        /*
+         * blocks are aligned to their size
+         */
+        for (size_t size = message_allocator::GRANULARITY;
+             size <= message_allocator::MAX_BLOCK_SIZE;
+             size *= 2)
+        {
+            std::vector<void *> blocks;
+            for (size_t ix = 0; ix < 100; ++ix)
+            {
+                blocks.push_back (message_allocator::allocate (size));
+                assert (is_aligned (blocks.back (), size));
+            }
+            for (void * ptr : blocks)
+            {
+                message_allocator::deallocate (ptr, size);
+            }
+        }
+
+        std::vector<message::upointer_type> msgs;
+        for (size_t ix = 0; ix < 100; ++ix)
+        {
+            msgs.emplace_back (new aligned_message (defQID, ix));
+            assert (is_aligned (msgs.back ().get (), alignof (aligned_message)));
+        }
+    }
+    {
+        /*
+         * nothrow new
+         */
+        message::upointer_type msg (new (std::nothrow) payload_message<100> (defQID, 1));
+        assert (nullptr != msg.get ());
+        assert (static_cast<payload_message<100> *> (msg.get ())->is_valid ());
+        msg.reset (new (std::nothrow) payload_message<1000> (defQID, 2));
+        assert (static_cast<payload_message<1000> *> (msg.get ())->is_valid ());
+        msg.reset (new (std::nothrow) aligned_message (defQID, 3));
+        assert (is_aligned (msg.get (), alignof (aligned_message)));
+        msg.reset ();
+
+        /* memory is released if constructor throws */
+        for (size_t ix = 0; ix < 2; ++ix)
+        {
+            try
+            {
+                msg.reset (new (std::nothrow) throwing_message (defQID, 4));
+                assert (false);
+            }
+            catch (const std::runtime_error &)
+            {
+            }
+        }
+        assert (nullptr == msg.get ());
+    }
+    {
+        /*
+         * messages of different sizes
+         */
+        message_queue queue (defQID);
+        for (size_t ix = 0; ix < 1000; ++ix)
+        {
+            queue.enqueue<message> (ix);
+            queue.enqueue<payload_message<8> > (ix);
+            queue.enqueue<payload_message<100> > (ix);
+            queue.enqueue<payload_message<1000> > (ix);
+        }
+
+        for (size_t ix = 0; ix < 1000; ++ix)
+        {
+            message::upointer_type msg = queue.pop ();
+            assert (ix == msg->get_mid ());
+            msg = queue.pop ();
+            assert (static_cast<payload_message<8> *> (msg.get ())->is_valid ());
+            msg = queue.pop ();
+            assert (static_cast<payload_message<100> *> (msg.get ())->is_valid ());
+            msg = queue.pop ();
+            assert (static_cast<payload_message<1000> *> (msg.get ())->is_valid ());
+        }
+        assert (nullptr == queue.pop ().get ());
+    }
+    {
+        /*
+         * messages allocated and released by different threads
+         */
+        const size_t NTHREADS = 4;
+        const size_t NMSGS = 100000;
+
+        mpsc_message_queue queue (defQID);
+        std::vector<std::thread> producers;
+        for (size_t ix = 0; ix < NTHREADS; ++ix)
+        {
+            producers.emplace_back ([&queue]{
+                    for (size_t i = 0; i < NMSGS; ++i)
+                    {
+                        queue.enqueue<payload_message<40> > (i);
+                    }
+                });
+        }
+
+        for (size_t nreceived = 0; nreceived < NTHREADS * NMSGS;)
+        {
+            message::upointer_type msg = queue.pop ();
+            if (msg)
+            {
+                assert (static_cast<payload_message<40> *> (msg.get ())->is_valid ());
+                ++nreceived;
+            }
+        }
+
+        for (auto & thr : producers)
+        {
+            thr.join ();
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,233 @@
+#include "mqmx/message_dispatcher.h"
+#include "mqmx/message_queue_pool.h"
+#include <crs/semaphore.h>
+
+#include <vector>
+
+#undef NDEBUG
+#include <cassert>
+
+namespace
+{
+    const mqmx::queue_id_type defQID = 10;
+    const mqmx::message_id_type FOO_MESSAGE_ID = 1;
+    const mqmx::message_id_type BAR_MESSAGE_ID = 3;
+    const mqmx::message_id_type UNKNOWN_MESSAGE_ID = 7;
+
+    struct foo_message : mqmx::message
+    {
+        int value;
+
+        foo_message (const mqmx::queue_id_type qid, const int v)
+            : mqmx::message (qid, FOO_MESSAGE_ID)
+            , value (v)
+        { }
+    };
+
+    struct bar_message : mqmx::message
+    {
+        std::vector<int> values;
+
+        bar_message (const mqmx::queue_id_type qid, const int v)
+            : mqmx::message (qid, BAR_MESSAGE_ID)
+            , values (2, v)
+        { }
+    };
+
+    struct visitor
+    {
+        int * sum;
+
+        mqmx::status_code operator () (foo_message & msg)
+        {
+            *sum += msg.value;
+            return mqmx::ExitStatus::Success;
+        }
+
+        mqmx::status_code operator () (bar_message & msg)
+        {
+            *sum += msg.values[0] + msg.values[1];
+            return mqmx::ExitStatus::Success;
+        }
+    };
+
+    struct counting_handler
+    {
+        int   count;
+        int * last;
+
+        mqmx::status_code operator () (foo_message &)
+        {
+            *last = ++count;
+            return mqmx::ExitStatus::Success;
+        }
+    };
+
+    typedef mqmx::static_message_dispatcher<
+        visitor,
+        mqmx::message_binding<FOO_MESSAGE_ID, foo_message>,
+        mqmx::message_binding<BAR_MESSAGE_ID, bar_message>> static_dispatcher_type;
+
+    template <typename message_type>
+    mqmx::message::upointer_type make (const int value)
+    {
+        return mqmx::message::upointer_type (new message_type (defQID, value));
+    }
+} /* namespace */
+
+int main ()
+{
+    {
+        /*
+         * handlers get messages downcast to registered types
+         */
+        using namespace mqmx;
+        int sum = 0;
+        message_dispatcher dispatcher;
+        assert (!dispatcher.has_handler (FOO_MESSAGE_ID));
+
+        status_code retCode = dispatcher.set_handler<foo_message> (
+            FOO_MESSAGE_ID, [&sum](foo_message & msg)
+            {
+                sum += msg.value;
+                return ExitStatus::Success;
+            });
+        assert (ExitStatus::Success == retCode);
+        retCode = dispatcher.set_handler<bar_message> (
+            BAR_MESSAGE_ID, [&sum](bar_message & msg)
+            {
+                sum += msg.values[0] + msg.values[1];
+                return (msg.values[0] < 0) ? ExitStatus::NotAllowed : ExitStatus::Success;
+            });
+        assert (ExitStatus::Success == retCode);
+        assert (dispatcher.has_handler (FOO_MESSAGE_ID));
+        assert (dispatcher.has_handler (BAR_MESSAGE_ID));
+        assert (!dispatcher.has_handler (2));
+        assert (!dispatcher.has_handler (UNKNOWN_MESSAGE_ID));
+
+        retCode = dispatcher.set_handler<foo_message> (
+            FOO_MESSAGE_ID, [](foo_message &) { return ExitStatus::Success; });
+        assert (ExitStatus::AlreadyExist == retCode);
+
+        assert (ExitStatus::Success == dispatcher.dispatch (make<foo_message> (1)));
+        assert (ExitStatus::Success == dispatcher.dispatch (make<bar_message> (10)));
+        assert (21 == sum);
+
+        /* status code of handler is returned */
+        assert (ExitStatus::NotAllowed == dispatcher.dispatch (make<bar_message> (-1)));
+        assert (19 == sum);
+
+        assert (ExitStatus::InvalidArgument == dispatcher.dispatch (nullptr));
+        assert (ExitStatus::NotFound == dispatcher.dispatch (
+                    message::upointer_type (new message (defQID, UNKNOWN_MESSAGE_ID))));
+
+        /* copy gets copies of handlers */
+        message_dispatcher copy (dispatcher);
+        assert (copy.has_handler (FOO_MESSAGE_ID));
+        assert (ExitStatus::Success == copy.dispatch (make<foo_message> (1)));
+        assert (20 == sum);
+    }
+    {
+        /*
+         * state of handlers isn't shared between copies
+         */
+        using namespace mqmx;
+        int last = 0;
+        message_dispatcher dispatcher;
+        dispatcher.set_handler<foo_message> (FOO_MESSAGE_ID, counting_handler {0, &last});
+        assert (ExitStatus::Success == dispatcher.dispatch (make<foo_message> (0)));
+        assert (1 == last);
+
+        message_dispatcher copy (dispatcher);
+        assert (ExitStatus::Success == copy.dispatch (make<foo_message> (0)));
+        assert (2 == last);
+        assert (ExitStatus::Success == copy.dispatch (make<foo_message> (0)));
+        assert (3 == last);
+        assert (ExitStatus::Success == dispatcher.dispatch (make<foo_message> (0)));
+        assert (2 == last);
+
+        message_dispatcher assigned;
+        assigned = copy;
+        assert (ExitStatus::Success == assigned.dispatch (make<foo_message> (0)));
+        assert (4 == last);
+        assert (ExitStatus::Success == copy.dispatch (make<foo_message> (0)));
+        assert (4 == last);
+    }
+    {
+        /*
+         * messages without handler are passed to the fallback handler
+         */
+        using namespace mqmx;
+        message_id_type fallback_mid = 0;
+        message_dispatcher dispatcher ([&fallback_mid](message::upointer_type && msg)
+                                       {
+                                           fallback_mid = msg->get_mid ();
+                                           return ExitStatus::Success;
+                                       });
+        assert (ExitStatus::Success == dispatcher.dispatch (
+                    message::upointer_type (new message (defQID, UNKNOWN_MESSAGE_ID))));
+        assert (UNKNOWN_MESSAGE_ID == fallback_mid);
+    }
+    {
+        /*
+         * table built at compile time
+         */
+        using namespace mqmx;
+        int sum = 0;
+        static_dispatcher_type dispatcher (visitor {&sum});
+        assert (&sum == dispatcher.get_visitor ().sum);
+
+        assert (ExitStatus::Success == dispatcher.dispatch (make<foo_message> (1)));
+        assert (ExitStatus::Success == dispatcher (make<bar_message> (10)));
+        assert (21 == sum);
+
+        assert (ExitStatus::InvalidArgument == dispatcher.dispatch (nullptr));
+        assert (ExitStatus::NotFound == dispatcher.dispatch (
+                    message::upointer_type (new message (defQID, 2))));
+        assert (ExitStatus::NotFound == dispatcher.dispatch (
+                    message::upointer_type (new message (defQID, UNKNOWN_MESSAGE_ID))));
+    }
+    {
+        /*
+         * dispatchers as handlers of message queue pool
+         */
+        using namespace mqmx;
+        const int NMSGS = 100;
+        message_queue_pool pool;
+        crs::semaphore sem;
+
+        int dynamic_sum = 0;
+        message_dispatcher dispatcher;
+        dispatcher.set_handler<foo_message> (
+            FOO_MESSAGE_ID, [&](foo_message & msg)
+            {
+                dynamic_sum += msg.value;
+                if (msg.value == NMSGS)
+                {
+                    sem.post ();
+                }
+                return ExitStatus::Success;
+            });
+
+        int static_sum = 0;
+        auto aqueue = pool.allocate_queue (dispatcher);
+        auto bqueue = pool.allocate_queue (static_dispatcher_type (visitor {&static_sum}));
+        assert (nullptr != aqueue.get ());
+        assert (nullptr != bqueue.get ());
+
+        for (int ix = 1; ix <= NMSGS; ++ix)
+        {
+            bqueue->enqueue<foo_message> (ix);
+        }
+        for (int ix = 1; ix <= NMSGS; ++ix)
+        {
+            aqueue->enqueue<foo_message> (ix);
+        }
+        sem.wait ();
+        assert (pool.is_poll_idle ());
+
+        assert (NMSGS * (NMSGS + 1) / 2 == dynamic_sum);
+        assert (NMSGS * (NMSGS + 1) / 2 == static_sum);
+    }
+    return 0;
+}
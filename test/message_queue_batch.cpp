@@ -0,0 +1,135 @@
+#include "mqmx/message_queue.h"
+#include "mqmx/mpsc_message_queue.h"
+#include "mqmx/spsc_message_queue.h"
+
+#include <vector>
+
+#undef NDEBUG
+#include <cassert>
+
+namespace
+{
+    struct counting_listener : mqmx::message_queue::listener
+    {
+        size_t ndata = 0;
+
+        virtual void notify (const mqmx::queue_id_type,
+                             mqmx::message_queue *,
+                             const mqmx::message_queue::notification_flags_type flags) override
+        {
+            if (flags & mqmx::message_queue::notification_flag::data)
+            {
+                ++ndata;
+            }
+        }
+    };
+
+    void test_batch (mqmx::message_queue & queue)
+    {
+        using namespace mqmx;
+        const message_id_type defMID = 10;
+        const size_t NMSGS = 10;
+
+        counting_listener listener;
+        queue.set_listener (listener);
+
+        message_queue::container_type batch;
+        status_code retCode = queue.push_batch (batch);
+        assert (ExitStatus::Success == retCode);
+        assert (0 == listener.ndata);
+
+        /* invalid batch is left intact */
+        batch.push_back (queue.new_message<message> (defMID));
+        batch.push_back (message::upointer_type ());
+        retCode = queue.push_batch (batch);
+        assert (ExitStatus::InvalidArgument == retCode);
+        assert (2 == batch.size ());
+
+        batch.back () = message::upointer_type (new message (queue.get_qid () + 1, defMID));
+        retCode = queue.push_batch (batch);
+        assert (ExitStatus::NotSupported == retCode);
+        assert (2 == batch.size ());
+        assert (nullptr != batch.front ().get ());
+        batch.clear ();
+
+        /* whole batch is reported once */
+        for (size_t ix = 0; ix < NMSGS; ++ix)
+        {
+            batch.push_back (queue.new_message<message> (defMID + ix));
+        }
+        retCode = queue.push_batch (batch);
+        assert (ExitStatus::Success == retCode);
+        assert (batch.empty ());
+        assert (1 == listener.ndata);
+
+        std::vector<message::upointer_type> range;
+        for (size_t ix = NMSGS; ix < 2 * NMSGS; ++ix)
+        {
+            range.push_back (queue.new_message<message> (defMID + ix));
+        }
+        retCode = queue.push_batch (std::begin (range), std::end (range));
+        assert (ExitStatus::Success == retCode);
+        assert (1 == listener.ndata);
+
+        /* drain in FIFO order */
+        message_queue::container_type out;
+        size_t count = queue.drain (out, NMSGS / 2);
+        assert (NMSGS / 2 == count);
+        assert (NMSGS / 2 == out.size ());
+
+        count = queue.drain (out, NMSGS);
+        assert (NMSGS == count);
+
+        auto rest = queue.pop_all ();
+        assert (NMSGS / 2 == rest.size ());
+        std::move (std::begin (rest), std::end (rest), std::back_inserter (out));
+
+        for (size_t ix = 0; ix < out.size (); ++ix)
+        {
+            assert (defMID + ix == out[ix]->get_mid ());
+        }
+
+        assert (0 == queue.drain (out));
+        assert (queue.pop_all ().empty ());
+
+        /* queue is empty, so next batch is reported once again */
+        for (auto & msg : range)
+        {
+            assert (nullptr == msg.get ());
+            msg = queue.new_message<message> (defMID);
+        }
+        retCode = queue.push_batch (std::begin (range), std::end (range));
+        assert (ExitStatus::Success == retCode);
+        assert (2 == listener.ndata);
+        queue.clear_listener ();
+    }
+}
+
+int main ()
+{
+    const mqmx::queue_id_type defQID = 10;
+    {
+        mqmx::message_queue queue (defQID);
+        test_batch (queue);
+    }
+    {
+        mqmx::mpsc_message_queue queue (defQID);
+        test_batch (queue);
+    }
+    {
+        mqmx::spsc_message_queue queue (defQID);
+        test_batch (queue);
+
+        mqmx::spsc_message_queue small (defQID, 4);
+        mqmx::message_queue::container_type batch;
+        for (size_t ix = 0; ix < 5; ++ix)
+        {
+            batch.push_back (small.new_message<mqmx::message> (ix));
+        }
+        assert (mqmx::ExitStatus::Overflow == small.push_batch (batch));
+        assert (5 == batch.size ());
+        batch.pop_back ();
+        assert (mqmx::ExitStatus::Success == small.push_batch (batch));
+    }
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include "mqmx/message_queue_poll.h"
+
+#undef NDEBUG
+#include <cassert>
+
+int main ()
+{
+    const mqmx::message_id_type defmid = 10;
+    {
+        /*
+         * notifications are ordered by priority, then by arrival
+         */
+        mqmx::message_queue_poll_listener listener (
+            mqmx::message_queue_poll_listener::priority_list, 8);
+        assert (mqmx::message_queue_poll_listener::priority_list == listener.get_mode ());
+        assert (0 == listener.get_priority (3));
+
+        listener.set_priority (3, 10);
+        listener.set_priority (100, -1);
+        assert (10 == listener.get_priority (3));
+        assert (-1 == listener.get_priority (100));
+
+        mqmx::message_queue aqueue (1);
+        mqmx::message_queue bqueue (2);
+        mqmx::message_queue cqueue (3);
+        mqmx::message_queue dqueue (100);
+        aqueue.set_listener (listener);
+        bqueue.set_listener (listener);
+        cqueue.set_listener (listener);
+        dqueue.set_listener (listener);
+
+        dqueue.enqueue<mqmx::message> (defmid);
+        bqueue.enqueue<mqmx::message> (defmid);
+        aqueue.enqueue<mqmx::message> (defmid);
+        cqueue.enqueue<mqmx::message> (defmid);
+
+        auto mqlist = listener.get_notifications ();
+        assert (4 == mqlist.size ());
+        assert (3 == mqlist[0].get_qid ());
+        assert (2 == mqlist[1].get_qid ());
+        assert (1 == mqlist[2].get_qid ());
+        assert (100 == mqlist[3].get_qid ());
+
+        listener.take_notifications (mqlist);
+        assert (4 == mqlist.size ());
+        assert (3 == mqlist[0].get_qid ());
+        assert (&cqueue == mqlist[0].get_mq ());
+        assert (100 == mqlist[3].get_qid ());
+        assert (listener.get_notifications ().empty ());
+
+        aqueue.clear_listener ();
+        bqueue.clear_listener ();
+        cqueue.clear_listener ();
+        dqueue.clear_listener ();
+    }
+    {
+        /*
+         * every take starts from the queue next to the previous first one
+         */
+        mqmx::message_queue_poll_listener listener (
+            mqmx::message_queue_poll_listener::round_robin_list);
+        assert (mqmx::message_queue_poll_listener::round_robin_list == listener.get_mode ());
+
+        mqmx::message_queue aqueue (1);
+        mqmx::message_queue bqueue (2);
+        mqmx::message_queue cqueue (3);
+        aqueue.set_listener (listener);
+        bqueue.set_listener (listener);
+        cqueue.set_listener (listener);
+
+        const auto notify_all = [&]
+            {
+                aqueue.pop_all ();
+                bqueue.pop_all ();
+                cqueue.pop_all ();
+                cqueue.enqueue<mqmx::message> (defmid);
+                aqueue.enqueue<mqmx::message> (defmid);
+                bqueue.enqueue<mqmx::message> (defmid);
+            };
+
+        mqmx::message_queue_poll_listener::notifications_list_type mqlist;
+        notify_all ();
+
+        /* getting the list doesn't move rotation point */
+        mqlist = listener.get_notifications ();
+        assert (3 == mqlist.size ());
+        assert (1 == mqlist[0].get_qid ());
+        assert (2 == mqlist[1].get_qid ());
+        assert (3 == mqlist[2].get_qid ());
+
+        listener.take_notifications (mqlist);
+        assert (3 == mqlist.size ());
+        assert (1 == mqlist[0].get_qid ());
+        assert (2 == mqlist[1].get_qid ());
+        assert (3 == mqlist[2].get_qid ());
+
+        notify_all ();
+        listener.take_notifications (mqlist);
+        assert (3 == mqlist.size ());
+        assert (2 == mqlist[0].get_qid ());
+        assert (3 == mqlist[1].get_qid ());
+        assert (1 == mqlist[2].get_qid ());
+
+        notify_all ();
+        listener.wait_and_take_notifications (mqlist,
+                                              mqmx::wait_time_provider (),
+                                              mqmx::wait_time_provider ());
+        assert (3 == mqlist.size ());
+        assert (3 == mqlist[0].get_qid ());
+        assert (1 == mqlist[1].get_qid ());
+        assert (2 == mqlist[2].get_qid ());
+
+        /* rotation point wraps around */
+        notify_all ();
+        listener.take_notifications (mqlist);
+        assert (1 == mqlist[0].get_qid ());
+
+        aqueue.clear_listener ();
+        bqueue.clear_listener ();
+        cqueue.clear_listener ();
+    }
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include "mqmx/message_queue_poll.h"
+
+#undef NDEBUG
+#include <cassert>
+
+int main ()
+{
+    {
+        /*
+         * notifications are kept in order of arrival
+         */
+        const mqmx::queue_id_type aqid = 20;
+        const mqmx::queue_id_type bqid = 10;
+        const mqmx::queue_id_type cqid = 1000;
+        const mqmx::message_id_type defmid = 10;
+
+        mqmx::message_queue_poll_listener listener (
+            mqmx::message_queue_poll_listener::ready_list, 32);
+        assert (mqmx::message_queue_poll_listener::ready_list == listener.get_mode ());
+
+        mqmx::message_queue aqueue (aqid);
+        mqmx::message_queue bqueue (bqid);
+        mqmx::message_queue cqueue (cqid);
+        aqueue.set_listener (listener);
+        bqueue.set_listener (listener);
+        cqueue.set_listener (listener);
+
+        aqueue.enqueue<mqmx::message> (defmid);
+        cqueue.enqueue<mqmx::message> (defmid);
+        bqueue.enqueue<mqmx::message> (defmid);
+
+        auto mqlist = listener.get_notifications ();
+        assert (3 == mqlist.size ());
+        assert (aqid == mqlist[0].get_qid ());
+        assert (cqid == mqlist[1].get_qid ());
+        assert (bqid == mqlist[2].get_qid ());
+        assert (&bqueue == mqlist[2].get_mq ());
+
+        /* the list is taken out, so the next notification starts the new one */
+        listener.take_notifications (mqlist);
+        assert (3 == mqlist.size ());
+        assert (listener.get_notifications ().empty ());
+
+        mqmx::message_queue_poll_listener::sort_by_qid (mqlist);
+        assert (bqid == mqlist[0].get_qid ());
+        assert (aqid == mqlist[1].get_qid ());
+        assert (cqid == mqlist[2].get_qid ());
+
+        /* queues are not empty, so only the new ones are reported */
+        aqueue.enqueue<mqmx::message> (defmid);
+        assert (listener.get_notifications ().empty ());
+
+        aqueue.pop_all ();
+        bqueue.pop_all ();
+        bqueue.enqueue<mqmx::message> (defmid);
+        aqueue.enqueue<mqmx::message> (defmid);
+        listener.wait_and_take_notifications (mqlist,
+                                              mqmx::wait_time_provider (),
+                                              mqmx::wait_time_provider ());
+        assert (2 == mqlist.size ());
+        assert (bqid == mqlist[0].get_qid ());
+        assert (aqid == mqlist[1].get_qid ());
+
+        aqueue.clear_listener ();
+        bqueue.clear_listener ();
+        cqueue.clear_listener ();
+    }
+    {
+        /*
+         * flags of the same queue are merged into single record
+         */
+        const mqmx::queue_id_type aqid = 5;
+        const mqmx::message_id_type defmid = 10;
+
+        mqmx::message_queue_poll_listener listener (
+            mqmx::message_queue_poll_listener::ready_list);
+        {
+            mqmx::message_queue aqueue (aqid);
+            aqueue.set_listener (listener);
+            aqueue.enqueue<mqmx::message> (defmid);
+        }
+
+        mqmx::message_queue_poll_listener::notifications_list_type mqlist;
+        listener.take_notifications (mqlist);
+        assert (1 == mqlist.size ());
+        assert (aqid == mqlist.front ().get_qid ());
+        assert ((mqmx::message_queue::notification_flag::data|
+                 mqmx::message_queue::notification_flag::closed) == mqlist.front ().get_flags ());
+    }
+    {
+        /*
+         * queues with undefined ID are not indexed, their notifications
+         * are just appended to the list
+         */
+        const mqmx::queue_id_type aqid = 5;
+        const mqmx::message_id_type defmid = 10;
+        const mqmx::message_queue_poll_listener::listener_mode modes[] = {
+            mqmx::message_queue_poll_listener::ready_list,
+            mqmx::message_queue_poll_listener::priority_list,
+            mqmx::message_queue_poll_listener::round_robin_list
+        };
+        for (const auto mode : modes)
+        {
+            mqmx::message_queue_poll_listener listener (mode, mqmx::message::undefined_qid);
+            listener.set_priority (mqmx::message::undefined_qid, 1);
+            assert (0 == listener.get_priority (mqmx::message::undefined_qid));
+            {
+                mqmx::message_queue aqueue (aqid);
+                mqmx::message_queue uqueue;
+                mqmx::message_queue vqueue;
+                aqueue.set_listener (listener);
+                uqueue.set_listener (listener);
+                vqueue.set_listener (listener);
+                aqueue.enqueue<mqmx::message> (defmid);
+            }
+
+            mqmx::message_queue_poll_listener::notifications_list_type mqlist;
+            listener.take_notifications (mqlist);
+            assert (3 == mqlist.size ());
+            size_t nundefined = 0;
+            for (const auto & rec : mqlist)
+            {
+                if (mqmx::message::undefined_qid == rec.get_qid ())
+                {
+                    assert (mqmx::message_queue::notification_flag::closed == rec.get_flags ());
+                    ++nundefined;
+                }
+            }
+            assert (2 == nundefined);
+
+            /* index is still consistent */
+            {
+                mqmx::message_queue aqueue (aqid);
+                aqueue.set_listener (listener);
+                aqueue.enqueue<mqmx::message> (defmid);
+                aqueue.enqueue<mqmx::message> (defmid);
+                assert (1 == listener.get_notifications ().size ());
+                aqueue.clear_listener ();
+            }
+        }
+    }
+    return 0;
+}
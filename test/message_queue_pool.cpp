@@ -1,6 +1,8 @@
 #include "mqmx/message_queue_pool.h"
 #include <crs/semaphore.h>
 
+#include <vector>
+
 #undef NDEBUG
 #include <cassert>
 
@@ -90,5 +92,82 @@ int main ()
         assert (NMSGS == counter_a);
         assert (NMSGS == counter_b);
     }
+    {
+        /*
+         * batch processing and handler failures
+         */
+        const size_t NMSGS = 1000;
+        crs::semaphore sem;
+        mqmx::message_queue_pool sut;
+        size_t counter = 0;
+        auto mq = sut.allocate_queue (
+            [&](mqmx::message::upointer_type && msg)
+            {
+                assert (counter == msg->get_mid ());
+                if (++counter == NMSGS)
+                {
+                    sem.post ();
+                }
+                return ((counter % 2)
+                        ? mqmx::ExitStatus::NotAllowed
+                        : mqmx::ExitStatus::Success);
+            });
+
+        mqmx::message_queue::container_type batch;
+        for (size_t i = 0; i < NMSGS; ++i)
+        {
+            batch.push_back (mq->new_message<mqmx::message> (i));
+        }
+        assert (mqmx::ExitStatus::Success == mq->push_batch (batch));
+        sem.wait ();
+        assert (NMSGS == counter);
+        assert (sut.is_poll_idle ());
+    }
+    {
+        /*
+         * many queues, only notified ones are handled
+         */
+        const size_t NQUEUES = 500;
+        crs::semaphore sem;
+        mqmx::message_queue_pool sut (NQUEUES);
+        std::vector<size_t> counters (NQUEUES + 1, 0);
+        std::vector<mqmx::message_queue_pool::mq_upointer_type> mqs;
+        for (size_t ix = 0; ix < NQUEUES; ++ix)
+        {
+            mqs.emplace_back (sut.allocate_queue (
+                                  [&](mqmx::message::upointer_type && msg)
+                                  {
+                                      ++counters[msg->get_qid ()];
+                                      sem.post ();
+                                      /* queue is still handled after failure */
+                                      return mqmx::ExitStatus::NotAllowed;
+                                  }));
+            assert (nullptr != mqs.back ().get ());
+        }
+
+        for (size_t round = 0; round < 3; ++round)
+        {
+            for (size_t ix = round; ix < NQUEUES; ix += 7)
+            {
+                mqs[ix]->enqueue<mqmx::message> (0);
+                mqs[ix]->enqueue<mqmx::message> (1);
+                sem.wait ();
+                sem.wait ();
+                assert (2 == counters[mqs[ix]->get_qid ()]);
+            }
+            assert (sut.is_poll_idle ());
+        }
+
+        /* queues removed with unhandled messages */
+        for (size_t ix = 0; ix < NQUEUES; ix += 2)
+        {
+            mqs[ix]->enqueue<mqmx::message> (0);
+            mqs[ix].reset ();
+        }
+        mqs[1]->enqueue<mqmx::message> (0);
+        sem.wait ();
+        mqs.clear ();
+        assert (sut.is_poll_idle ());
+    }
     return 0;
 }
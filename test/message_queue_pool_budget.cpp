@@ -0,0 +1,87 @@
+#include "mqmx/message_queue_pool.h"
+#include <crs/semaphore.h>
+
+#include <vector>
+
+#undef NDEBUG
+#include <cassert>
+
+int main ()
+{
+    {
+        /*
+         * sanity checks
+         */
+        mqmx::message_queue_pool sut;
+        assert (0 == sut.get_queue_budget ());
+
+        mqmx::message_queue_pool sut2 (15, 1, 8);
+        assert (8 == sut2.get_queue_budget ());
+    }
+    {
+        /*
+         * queue, which exhausted its budget, is revisited after other queues
+         */
+        const size_t BUDGET = 4;
+        const size_t NMSGS = 100;
+        mqmx::message_queue_pool sut (15, 1, BUDGET);
+        crs::semaphore blocked;
+        crs::semaphore release;
+        crs::semaphore done;
+
+        /* handled by the single worker only, so no synchronization is needed */
+        std::vector<mqmx::message_id_type> bulk_log;
+        size_t small_position = 0;
+
+        auto blocker = sut.allocate_queue (
+            [&](mqmx::message::upointer_type &&)
+            {
+                blocked.post ();
+                release.wait ();
+                return mqmx::ExitStatus::Success;
+            });
+        auto bulk = sut.allocate_queue (
+            [&](mqmx::message::upointer_type && msg)
+            {
+                bulk_log.push_back (msg->get_mid ());
+                if (bulk_log.size () == NMSGS)
+                {
+                    done.post ();
+                }
+                return mqmx::ExitStatus::Success;
+            });
+        auto small = sut.allocate_queue (
+            [&](mqmx::message::upointer_type &&)
+            {
+                small_position = bulk_log.size ();
+                done.post ();
+                return mqmx::ExitStatus::Success;
+            });
+        assert (nullptr != blocker.get ());
+        assert (nullptr != bulk.get ());
+        assert (nullptr != small.get ());
+
+        /* both queues become ready while the worker is blocked */
+        blocker->enqueue<mqmx::message> (0);
+        blocked.wait ();
+        for (size_t ix = 0; ix < NMSGS; ++ix)
+        {
+            bulk->enqueue<mqmx::message> (ix);
+        }
+        small->enqueue<mqmx::message> (0);
+        release.post ();
+
+        done.wait ();
+        done.wait ();
+        assert (small_position <= BUDGET);
+
+        /* budget doesn't break FIFO order of the queue */
+        assert (NMSGS == bulk_log.size ());
+        for (size_t ix = 0; ix < NMSGS; ++ix)
+        {
+            assert (ix == bulk_log[ix]);
+        }
+        assert (sut.is_poll_idle ());
+    }
+    return 0;
+}
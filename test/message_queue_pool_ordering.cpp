@@ -0,0 +1,74 @@
+#include "mqmx/message_queue_pool.h"
+#include <crs/semaphore.h>
+
+#include <vector>
+
+#undef NDEBUG
+#include <cassert>
+
+int main ()
+{
+    {
+        /*
+         * sanity checks
+         */
+        mqmx::message_queue_pool sut;
+        assert (mqmx::message_queue_poll_listener::ready_list == sut.get_queue_order ());
+        assert (mqmx::ExitStatus::InvalidArgument == sut.set_queue_priority (nullptr, 1));
+
+        mqmx::message_queue foreign (100);
+        assert (mqmx::ExitStatus::NotFound == sut.set_queue_priority (&foreign, 1));
+    }
+    {
+        /*
+         * queues notified at once are handled in order of their priorities
+         */
+        mqmx::message_queue_pool sut (15, 1, 0, mqmx::message_queue_poll_listener::priority_list);
+        assert (mqmx::message_queue_poll_listener::priority_list == sut.get_queue_order ());
+        crs::semaphore blocked;
+        crs::semaphore release;
+        crs::semaphore done;
+
+        /* handled by the single worker only, so no synchronization is needed */
+        std::vector<mqmx::message_id_type> log;
+
+        auto blocker = sut.allocate_queue (
+            [&](mqmx::message::upointer_type &&)
+            {
+                blocked.post ();
+                release.wait ();
+                return mqmx::ExitStatus::Success;
+            });
+        const auto handler = [&](mqmx::message::upointer_type && msg)
+            {
+                log.push_back (msg->get_mid ());
+                done.post ();
+                return mqmx::ExitStatus::Success;
+            };
+
+        std::vector<mqmx::message_queue_pool::mq_upointer_type> mqs;
+        for (int ix = 0; ix < 3; ++ix)
+        {
+            mqs.emplace_back (sut.allocate_queue (handler));
+            assert (mqmx::ExitStatus::Success == sut.set_queue_priority (mqs.back ().get (), ix));
+        }
+
+        blocker->enqueue<mqmx::message> (0);
+        blocked.wait ();
+        for (size_t ix = 0; ix < mqs.size (); ++ix)
+        {
+            mqs[ix]->enqueue<mqmx::message> (ix);
+        }
+        release.post ();
+
+        done.wait ();
+        done.wait ();
+        done.wait ();
+        assert (3 == log.size ());
+        assert (2 == log[0]);
+        assert (1 == log[1]);
+        assert (0 == log[2]);
+        assert (sut.is_poll_idle ());
+    }
+    return 0;
+}
@@ -0,0 +1,163 @@
+#include "mqmx/message_queue_pool.h"
+#include <crs/semaphore.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#undef NDEBUG
+#include <cassert>
+
+int main ()
+{
+    {
+        /*
+         * sanity checks
+         */
+        mqmx::message_queue_pool sut (15, 4);
+        assert (4 == sut.get_workers_count ());
+        assert (sut.is_poll_idle ());
+
+        mqmx::message_queue_pool sut2 (15, 0);
+        assert (1 == sut2.get_workers_count ());
+    }
+    {
+        /*
+         * ready queues of busy worker are stolen by idle workers
+         */
+        const size_t NWORKERS = 4;
+        mqmx::message_queue_pool sut (16, NWORKERS);
+        crs::semaphore blocked;
+        crs::semaphore release;
+        crs::semaphore done;
+        std::atomic<size_t> started (0);
+        std::atomic<size_t> concurrent (0);
+
+        /* the first queue blocks the first worker, the rest wait for each other */
+        const auto handler = [&](mqmx::message::upointer_type && msg)
+            {
+                if (msg->get_mid () == 0)
+                {
+                    blocked.post ();
+                    release.wait ();
+                    return mqmx::ExitStatus::Success;
+                }
+
+                ++started;
+                const auto deadline = std::chrono::steady_clock::now () + std::chrono::seconds (5);
+                while ((started.load () < 3) && (std::chrono::steady_clock::now () < deadline))
+                {
+                    std::this_thread::yield ();
+                }
+                if (started.load () == 3)
+                {
+                    ++concurrent;
+                }
+                done.post ();
+                return mqmx::ExitStatus::Success;
+            };
+
+        /* queues with qid divisible by NWORKERS belong to the first worker */
+        std::vector<mqmx::message_queue_pool::mq_upointer_type> mqs;
+        std::vector<mqmx::message_queue *> owned;
+        for (size_t ix = 0; ix < 16; ++ix)
+        {
+            mqs.emplace_back (sut.allocate_queue (handler));
+            assert (nullptr != mqs.back ().get ());
+            if (mqs.back ()->get_qid () % NWORKERS == 0)
+            {
+                owned.push_back (mqs.back ().get ());
+            }
+        }
+        assert (4 == owned.size ());
+
+        /* block the first worker, so the rest of its queues become ready at once */
+        owned[0]->enqueue<mqmx::message> (0);
+        blocked.wait ();
+        for (size_t ix = 1; ix < owned.size (); ++ix)
+        {
+            owned[ix]->enqueue<mqmx::message> (1);
+        }
+
+        release.post ();
+        done.wait ();
+        done.wait ();
+        done.wait ();
+        assert (3 == concurrent.load ());
+        assert (sut.is_poll_idle ());
+    }
+    {
+        /*
+         * per queue FIFO order and exclusive handling
+         */
+        const size_t NQUEUES = 16;
+        const size_t NMSGS = 2000;
+        mqmx::message_queue_pool sut (NQUEUES, 4);
+        crs::semaphore sem;
+
+        struct queue_state
+        {
+            std::atomic<bool> active;
+            size_t            counter;
+        };
+        std::vector<queue_state> states (NQUEUES);
+        std::vector<mqmx::message_queue_pool::mq_upointer_type> mqs;
+        for (size_t ix = 0; ix < NQUEUES; ++ix)
+        {
+            queue_state & state = states[ix];
+            state.active = false;
+            state.counter = 0;
+            mqs.emplace_back (sut.allocate_queue (
+                                  [&state, &sem](mqmx::message::upointer_type && msg)
+                                  {
+                                      assert (!state.active.exchange (true));
+                                      assert (state.counter == msg->get_mid ());
+                                      const bool last = (++state.counter == NMSGS);
+                                      state.active = false;
+                                      if (last)
+                                      {
+                                          sem.post ();
+                                      }
+                                      return ((state.counter % 3)
+                                              ? mqmx::ExitStatus::Success
+                                              : mqmx::ExitStatus::NotAllowed);
+                                  }));
+            assert (nullptr != mqs.back ().get ());
+        }
+
+        std::vector<std::thread> producers;
+        for (size_t t = 0; t < 4; ++t)
+        {
+            producers.emplace_back ([&mqs, t]
+                                    {
+                                        for (size_t i = 0; i < NMSGS; ++i)
+                                        {
+                                            for (size_t ix = t; ix < NQUEUES; ix += 4)
+                                            {
+                                                mqs[ix]->enqueue<mqmx::message> (i);
+                                            }
+                                        }
+                                    });
+        }
+        for (auto & producer : producers)
+        {
+            producer.join ();
+        }
+
+        for (size_t ix = 0; ix < NQUEUES; ++ix)
+        {
+            sem.wait ();
+        }
+        for (const auto & state : states)
+        {
+            assert (NMSGS == state.counter);
+        }
+        assert (sut.is_poll_idle ());
+
+        /* queues are removed while the pool is running */
+        mqs.clear ();
+        assert (sut.is_poll_idle ());
+    }
+    return 0;
+}
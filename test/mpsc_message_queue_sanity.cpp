@@ -0,0 +1,153 @@
+#include "mqmx/mpsc_message_queue.h"
+#include "mqmx/message_queue_poll.h"
+#include "mqmx/message_queue_pool.h"
+#include <crs/semaphore.h>
+
+#include <thread>
+#include <vector>
+
+#undef NDEBUG
+#include <cassert>
+
+int main ()
+{
+    {
+        /*
+         * sanity checks
+         */
+        using namespace mqmx;
+        const queue_id_type defQID = 10;
+        const message_id_type defMID = 10;
+
+        mpsc_message_queue queue (defQID);
+        message::upointer_type msg (queue.pop ());
+        assert (nullptr == msg.get ());
+
+        status_code retCode = queue.push (nullptr);
+        assert (ExitStatus::InvalidArgument == retCode);
+
+        {
+            message_queue queue2 (defQID + 1);
+            retCode = queue.push (queue2.new_message<message> (defQID));
+            assert (ExitStatus::NotSupported == retCode);
+        }
+
+        retCode = queue.enqueue<message> (defMID);
+        assert (ExitStatus::Success == retCode);
+    }
+    {
+        /*
+         * FIFO order and notifications
+         */
+        using namespace mqmx;
+        const queue_id_type defQID = 10;
+        const message_id_type defMID = 10;
+
+        mpsc_message_queue queue (defQID);
+        for (size_t ix = 0; ix < 10; ++ix)
+        {
+            status_code retCode = queue.enqueue<message> (defMID + ix);
+            assert (ExitStatus::Success == retCode);
+        }
+
+        message_queue * queues[] = { &queue };
+        auto mqlist = poll (std::begin (queues), std::end (queues));
+        assert (1 == mqlist.size ());
+        assert (defQID == mqlist.front ().get_qid ());
+        assert (message_queue::notification_flag::data == mqlist.front ().get_flags ());
+
+        message::upointer_type msg;
+        for (size_t ix = 0; ix < 10; ++ix)
+        {
+            msg = queue.pop ();
+            assert (nullptr != msg.get ());
+            assert (defQID == msg->get_qid ());
+            assert ((defMID + ix) == msg->get_mid ());
+        }
+
+        msg = queue.pop ();
+        assert (nullptr == msg.get ());
+
+        mqlist = poll (std::begin (queues), std::end (queues));
+        assert (mqlist.empty ());
+    }
+    {
+        /*
+         * multiple producers
+         */
+        using namespace mqmx;
+        const queue_id_type defQID = 10;
+        const size_t NTHREADS = 8;
+        const size_t NMSGS = 10000;
+
+        mpsc_message_queue queue (defQID);
+        std::vector<std::thread> producers;
+        for (size_t ix = 0; ix < NTHREADS; ++ix)
+        {
+            producers.emplace_back ([&queue, ix]{
+                    for (size_t i = 0; i < NMSGS; ++i)
+                    {
+                        queue.enqueue<message> (ix * NMSGS + i);
+                    }
+                });
+        }
+
+        std::vector<size_t> last (NTHREADS, 0);
+        for (size_t nreceived = 0; nreceived < NTHREADS * NMSGS;)
+        {
+            message::upointer_type msg = queue.pop ();
+            if (msg)
+            {
+                /* per-producer FIFO order */
+                const size_t producer = msg->get_mid () / NMSGS;
+                const size_t seqno = msg->get_mid () % NMSGS + 1;
+                assert (last[producer] < seqno);
+                last[producer] = seqno;
+                ++nreceived;
+            }
+        }
+
+        for (auto & thr : producers)
+        {
+            thr.join ();
+        }
+        assert (nullptr == queue.pop ().get ());
+    }
+    {
+        /*
+         * message queue pool
+         */
+        const size_t NMSGS = 1000;
+        crs::semaphore sem;
+        mqmx::message_queue_pool sut;
+        size_t counter = 0;
+        auto mq = sut.allocate_queue<mqmx::mpsc_message_queue> (
+            [&](mqmx::message::upointer_type &&)
+            {
+                if (++counter == NMSGS)
+                {
+                    sem.post ();
+                }
+                return mqmx::ExitStatus::Success;
+            });
+        assert (nullptr != mq.get ());
+
+        std::thread threada ([&](){
+                for (size_t i = NMSGS / 2; 0 < i; --i)
+                {
+                    mq->enqueue<mqmx::message> (i);
+                }
+            });
+        std::thread threadb ([&](){
+                for (size_t i = NMSGS / 2; 0 < i; --i)
+                {
+                    mq->enqueue<mqmx::message> (i);
+                }
+            });
+        threada.join ();
+        threadb.join ();
+        sem.wait ();
+        assert (NMSGS == counter);
+    }
+    return 0;
+}
@@ -0,0 +1,175 @@
+#include "mqmx/queue_stats.h"
+#include "mqmx/message_queue_pool.h"
+#include "mqmx/mpsc_message_queue.h"
+#include "mqmx/spsc_message_queue.h"
+#include <crs/semaphore.h>
+
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <thread>
+
+#undef NDEBUG
+#include <cassert>
+
+namespace
+{
+    uint64_t histogram_total (const mqmx::queue_stats::snapshot_type & snapshot)
+    {
+        return std::accumulate (std::begin (snapshot.time_in_queue),
+                                std::end (snapshot.time_in_queue), uint64_t (0));
+    }
+
+    void check_queue (mqmx::message_queue & queue)
+    {
+        using namespace mqmx;
+        queue_stats stats;
+        assert (nullptr == queue.get_stats ());
+        queue.set_stats (&stats);
+        assert (&stats == queue.get_stats ());
+
+        for (message_id_type mid = 0; mid < 5; ++mid)
+        {
+            assert (ExitStatus::Success == queue.enqueue<message> (mid));
+        }
+        message_queue::container_type batch;
+        batch.push_back (queue.new_message<message> (5));
+        batch.push_back (queue.new_message<message> (6));
+        assert (ExitStatus::Success == queue.push_batch (batch));
+
+        queue_stats::snapshot_type snapshot = stats.get_snapshot (queue.get_qid ());
+        assert (queue.get_qid () == snapshot.qid);
+        assert (7 == snapshot.enqueued);
+        assert (0 == snapshot.dequeued);
+        assert (7 == snapshot.depth);
+        assert (7 == snapshot.max_depth);
+
+        std::this_thread::sleep_for (std::chrono::milliseconds (2));
+        assert (nullptr != queue.pop ().get ());
+        message_queue::container_type out;
+        assert (3 == queue.drain (out, 3));
+
+        snapshot = stats.get_snapshot (queue.get_qid ());
+        assert (4 == snapshot.dequeued);
+        assert (3 == snapshot.depth);
+        assert (7 == snapshot.max_depth);
+        assert (4 == histogram_total (snapshot));
+
+        /* messages spent at least 2ms (bucket [1024, 2048) us and above) */
+        assert (0 == std::accumulate (std::begin (snapshot.time_in_queue),
+                                      std::next (std::begin (snapshot.time_in_queue), 11),
+                                      uint64_t (0)));
+
+        queue.set_stats (nullptr);
+        queue.pop_all ();
+        assert (4 == stats.get_snapshot (queue.get_qid ()).dequeued);
+
+        stats.reset ();
+        snapshot = stats.get_snapshot (queue.get_qid ());
+        assert (0 == snapshot.enqueued);
+        assert (0 == snapshot.max_depth);
+        assert (0 == histogram_total (snapshot));
+    }
+} /* namespace */
+
+int main ()
+{
+    {
+        /*
+         * statistics of message queue backends
+         */
+        mqmx::message_queue queue (10);
+        check_queue (queue);
+
+        mqmx::mpsc_message_queue mpsc (10);
+        check_queue (mpsc);
+
+        mqmx::spsc_message_queue spsc (10);
+        check_queue (spsc);
+    }
+    {
+        /*
+         * pool-wide statistics
+         */
+        using namespace mqmx;
+        const size_t NMSGS = 100;
+
+        message_queue_pool plain;
+        assert (plain.get_stats ().empty ());
+
+        message_queue_pool sut (15, 2, 0, message_queue_poll_listener::ready_list, true);
+        crs::semaphore sem;
+        size_t counter = 0;
+        auto aqueue = sut.allocate_queue ([&](message::upointer_type &&)
+                                          {
+                                              if (++counter == NMSGS)
+                                              {
+                                                  sem.post ();
+                                              }
+                                              return ExitStatus::Success;
+                                          });
+        auto bqueue = sut.allocate_queue ([](message::upointer_type &&)
+                                          {
+                                              return ExitStatus::Success;
+                                          });
+        assert (nullptr != aqueue->get_stats ());
+
+        for (message_id_type mid = 0; mid < NMSGS; ++mid)
+        {
+            aqueue->enqueue<message> (mid);
+        }
+        sem.wait ();
+        assert (sut.is_poll_idle ());
+
+        const auto snapshots = sut.get_stats ();
+        assert (2 == snapshots.size ());
+        assert (aqueue->get_qid () == snapshots[0].qid);
+        assert (bqueue->get_qid () == snapshots[1].qid);
+
+        assert (NMSGS == snapshots[0].enqueued);
+        assert (NMSGS == snapshots[0].dequeued);
+        assert (0 == snapshots[0].depth);
+        assert (0 < snapshots[0].max_depth);
+        assert (NMSGS == snapshots[0].handled);
+        assert (NMSGS == histogram_total (snapshots[0]));
+
+        assert (0 == snapshots[1].enqueued);
+        assert (0 == snapshots[1].handled);
+
+        /* removed queues are not reported */
+        bqueue.reset ();
+        const auto remaining = sut.get_stats ();
+        assert (1 == remaining.size ());
+        assert (aqueue->get_qid () == remaining[0].qid);
+    }
+    {
+        /*
+         * statistics are collected while queues are allocated and removed
+         */
+        using namespace mqmx;
+        const size_t NQUEUES = 50;
+
+        message_queue_pool sut (NQUEUES, 2, 0, message_queue_poll_listener::ready_list, true);
+        std::atomic<bool> stop (false);
+        std::thread reader ([&]{
+                while (!stop.load ())
+                {
+                    assert (sut.get_stats ().size () <= 1);
+                }
+            });
+
+        for (size_t ix = 0; ix < NQUEUES; ++ix)
+        {
+            auto queue = sut.allocate_queue ([](message::upointer_type &&)
+                                             {
+                                                 return ExitStatus::Success;
+                                             });
+            assert (nullptr != queue.get ());
+            assert (1 == sut.get_stats ().size ());
+        }
+        stop.store (true);
+        reader.join ();
+        assert (sut.get_stats ().empty ());
+    }
+    return 0;
+}
@@ -0,0 +1,159 @@
+#include "mqmx/spsc_message_queue.h"
+#include "mqmx/message_queue_poll.h"
+#include "mqmx/message_queue_pool.h"
+#include <crs/semaphore.h>
+
+#include <thread>
+
+#undef NDEBUG
+#include <cassert>
+
+int main ()
+{
+    {
+        /*
+         * sanity checks
+         */
+        using namespace mqmx;
+        const queue_id_type defQID = 10;
+        const message_id_type defMID = 10;
+
+        spsc_message_queue queue (defQID, 3);
+        assert (4 == queue.get_capacity ());
+
+        message::upointer_type msg (queue.pop ());
+        assert (nullptr == msg.get ());
+
+        status_code retCode = queue.push (nullptr);
+        assert (ExitStatus::InvalidArgument == retCode);
+
+        {
+            message_queue queue2 (defQID + 1);
+            retCode = queue.push (queue2.new_message<message> (defQID));
+            assert (ExitStatus::NotSupported == retCode);
+        }
+
+        for (size_t ix = 0; ix < queue.get_capacity (); ++ix)
+        {
+            retCode = queue.enqueue<message> (defMID);
+            assert (ExitStatus::Success == retCode);
+        }
+
+        msg = queue.new_message<message> (defMID);
+        retCode = queue.push (std::move (msg));
+        assert (ExitStatus::Overflow == retCode);
+        assert (nullptr != msg.get ());
+
+        assert (nullptr != queue.pop ().get ());
+        retCode = queue.push (std::move (msg));
+        assert (ExitStatus::Success == retCode);
+    }
+    {
+        /*
+         * FIFO order and notifications
+         */
+        using namespace mqmx;
+        const queue_id_type defQID = 10;
+        const message_id_type defMID = 10;
+
+        spsc_message_queue queue (defQID, 16);
+        for (size_t ix = 0; ix < 10; ++ix)
+        {
+            status_code retCode = queue.enqueue<message> (defMID + ix);
+            assert (ExitStatus::Success == retCode);
+        }
+
+        message_queue * queues[] = { &queue };
+        auto mqlist = poll (std::begin (queues), std::end (queues));
+        assert (1 == mqlist.size ());
+        assert (defQID == mqlist.front ().get_qid ());
+        assert (message_queue::notification_flag::data == mqlist.front ().get_flags ());
+
+        message::upointer_type msg;
+        for (size_t ix = 0; ix < 10; ++ix)
+        {
+            msg = queue.pop ();
+            assert (nullptr != msg.get ());
+            assert (defQID == msg->get_qid ());
+            assert ((defMID + ix) == msg->get_mid ());
+        }
+
+        msg = queue.pop ();
+        assert (nullptr == msg.get ());
+
+        mqlist = poll (std::begin (queues), std::end (queues));
+        assert (mqlist.empty ());
+    }
+    {
+        /*
+         * producer and consumer threads
+         */
+        using namespace mqmx;
+        const queue_id_type defQID = 10;
+        const size_t NMSGS = 100000;
+
+        spsc_message_queue queue (defQID, 64);
+        std::thread producer ([&queue]{
+                for (size_t i = 0; i < NMSGS;)
+                {
+                    if (queue.enqueue<message> (i) == ExitStatus::Success)
+                    {
+                        ++i;
+                    }
+                    else
+                    {
+                        /* queue is full - let consumer run */
+                        std::this_thread::yield ();
+                    }
+                }
+            });
+
+        for (size_t nreceived = 0; nreceived < NMSGS;)
+        {
+            message::upointer_type msg = queue.pop ();
+            if (msg)
+            {
+                assert (nreceived == msg->get_mid ());
+                ++nreceived;
+            }
+            else
+            {
+                /* queue is empty - let producer run */
+                std::this_thread::yield ();
+            }
+        }
+        producer.join ();
+        assert (nullptr == queue.pop ().get ());
+    }
+    {
+        /*
+         * message queue pool
+         */
+        const size_t NMSGS = 1000;
+        crs::semaphore sem;
+        mqmx::message_queue_pool sut;
+        size_t counter = 0;
+        auto mq = sut.allocate_queue<mqmx::spsc_message_queue> (
+            [&](mqmx::message::upointer_type && msg)
+            {
+                assert (counter == msg->get_mid ());
+                if (++counter == NMSGS)
+                {
+                    sem.post ();
+                }
+                return mqmx::ExitStatus::Success;
+            }, NMSGS);
+        assert (nullptr != mq.get ());
+
+        std::thread producer ([&](){
+                for (size_t i = 0; i < NMSGS; ++i)
+                {
+                    mq->enqueue<mqmx::message> (i);
+                }
+            });
+        producer.join ();
+        sem.wait ();
+        assert (NMSGS == counter);
+    }
+    return 0;
+}
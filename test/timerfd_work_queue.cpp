@@ -0,0 +1,102 @@
+#include "mqmx/timerfd_work_queue.h"
+#include <crs/semaphore.h>
+
+#include <vector>
+
+#undef NDEBUG
+#include <cassert>
+
+int main ()
+{
+#if defined(__linux__)
+    using namespace mqmx;
+    using namespace std::chrono;
+
+    for (const auto spin : {work_queue::duration_type (), work_queue::duration_type (microseconds (200))})
+    {
+        {
+            /*
+             * works are executed in order of their time points and never
+             * earlier than them
+             */
+            timerfd_work_queue sut (spin);
+            assert (sut.is_timerfd_used ());
+            assert (spin == sut.get_spin ());
+
+            crs::semaphore sem;
+            std::vector<int> order;
+            bool early = false;
+
+            const work_queue::client_id_type client_id = sut.get_client_id ();
+            const work_queue::time_point_type now = sut.get_current_time_point ();
+            for (int i : {3, 1, 2})
+            {
+                const work_queue::time_point_type tp = now + milliseconds (5 * i);
+                assert (ExitStatus::Success == sut.schedule_work (
+                            client_id,
+                            [&, i, tp](const work_queue::work_id_type) {
+                                early = early || (sut.get_current_time_point () < tp);
+                                order.push_back (i);
+                                sem.post ();
+                                return false;
+                            },
+                            tp).first);
+            }
+
+            for (int i = 0; i < 3; ++i)
+                assert (sem.wait_for (seconds (1)));
+            assert ((std::vector<int> {1, 2, 3}) == order);
+            assert (!early);
+        }
+        {
+            /*
+             * worker sleeping for far time point is woken up by new works,
+             * cancelled works are not executed
+             */
+            timerfd_work_queue sut (spin);
+            crs::semaphore sem;
+            const work_queue::client_id_type client_id = sut.get_client_id ();
+            const work_queue::work_id_type far_id = sut.schedule_work (
+                client_id, [](const work_queue::work_id_type) { return false; },
+                sut.get_current_time_point () + hours (1)).second;
+            std::this_thread::sleep_for (milliseconds (5));
+
+            assert (ExitStatus::Success == sut.schedule_work (
+                        client_id,
+                        [&sem](const work_queue::work_id_type) {
+                            sem.post ();
+                            return false;
+                        },
+                        sut.get_current_time_point () + milliseconds (1)).first);
+            assert (sem.wait_for (seconds (1)));
+
+            assert (ExitStatus::Success == sut.cancel_work (far_id));
+            for (int i = 0; (i < 1000) && !sut.is_idle (); ++i)
+                std::this_thread::sleep_for (milliseconds (1));
+            assert (sut.is_idle ());
+        }
+    }
+    {
+        /*
+         * periodic works with pool of executors
+         */
+        timerfd_work_queue sut (2, false);
+        assert (2 == sut.get_executors_count ());
+
+        crs::semaphore sem;
+        const work_queue::client_id_type client_id = sut.get_client_id ();
+        const work_queue::work_id_type work_id = sut.schedule_work (
+            client_id,
+            [&sem](const work_queue::work_id_type) {
+                sem.post ();
+                return true;
+            },
+            sut.get_current_time_point () + milliseconds (1), milliseconds (1)).second;
+
+        for (int i = 0; i < 10; ++i)
+            assert (sem.wait_for (seconds (1)));
+        assert (ExitStatus::Success == sut.cancel_work (work_id));
+    }
+#endif
+    return 0;
+}
@@ -0,0 +1,211 @@
+#include "mqmx/value_message_queue.h"
+#include "mqmx/message_queue_poll.h"
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#undef NDEBUG
+#include <cassert>
+
+namespace
+{
+    struct small_payload
+    {
+        int  a;
+        long b;
+    };
+
+    struct big_payload
+    {
+        char data[256];
+    };
+
+    struct counted_payload
+    {
+        static int alive;
+
+        std::string value;
+
+        explicit counted_payload (const std::string & v)
+            : value (v)
+        {
+            ++alive;
+        }
+
+        counted_payload (counted_payload && o) noexcept
+            : value (std::move (o.value))
+        {
+            ++alive;
+        }
+
+        ~counted_payload ()
+        {
+            --alive;
+        }
+    };
+
+    int counted_payload::alive = 0;
+} /* namespace */
+
+int main ()
+{
+    {
+        /*
+         * envelope sanity checks
+         */
+        using namespace mqmx;
+        const queue_id_type defQID = 10;
+        const message_id_type defMID = 20;
+
+        static_assert (sizeof (value_message) == 64, "value_message should fit cache line");
+
+        value_message msg;
+        assert (message::undefined_qid == msg.get_qid ());
+        assert (!msg.has_payload ());
+        assert (nullptr == msg.get<small_payload> ());
+
+        msg = value_message::make<small_payload> (defQID, defMID, small_payload { 1, 2 });
+        assert (defQID == msg.get_qid ());
+        assert (defMID == msg.get_mid ());
+        assert (msg.has_payload ());
+        assert (msg.is_inline ());
+        assert (nullptr == msg.get<big_payload> ());
+        assert (nullptr != msg.get<small_payload> ());
+        assert (1 == msg.get<small_payload> ()->a);
+        assert (2 == msg.get<small_payload> ()->b);
+
+        value_message msg2 (std::move (msg));
+        assert (!msg.has_payload ());
+        assert (2 == msg2.get<small_payload> ()->b);
+
+        msg = value_message::make<big_payload> (defQID, defMID);
+        assert (msg.has_payload ());
+        assert (!msg.is_inline ());
+        big_payload * big = msg.get<big_payload> ();
+        assert (nullptr != big);
+        msg2 = std::move (msg);
+        assert (big == msg2.get<big_payload> ());
+
+        /* unique_ptr is not trivially copyable, but fits inline */
+        msg = value_message::make<std::unique_ptr<int>> (defQID, defMID, new int (5));
+        assert (msg.is_inline ());
+        msg2 = std::move (msg);
+        assert (5 == **msg2.get<std::unique_ptr<int>> ());
+    }
+    {
+        /*
+         * payloads are destroyed exactly once
+         */
+        using namespace mqmx;
+        const queue_id_type defQID = 10;
+        {
+            value_message msg = value_message::make<counted_payload> (defQID, 1, "abc");
+            assert (msg.is_inline ());
+            assert (1 == counted_payload::alive);
+
+            value_message msg2 (std::move (msg));
+            assert (1 == counted_payload::alive);
+            assert ("abc" == msg2.get<counted_payload> ()->value);
+
+            msg2.reset ();
+            assert (0 == counted_payload::alive);
+
+            basic_value_message<8> msg3 = basic_value_message<8>::make<counted_payload> (defQID, 1, "def");
+            assert (!msg3.is_inline ());
+            assert (1 == counted_payload::alive);
+        }
+        assert (0 == counted_payload::alive);
+    }
+    {
+        /*
+         * queue sanity checks
+         */
+        using namespace mqmx;
+        const queue_id_type defQID = 10;
+        const message_id_type defMID = 10;
+
+        value_message_queue<> queue (defQID);
+        value_message msg;
+        assert (!queue.pop_value (msg));
+
+        status_code retCode = queue.push_value (value_message (defQID + 1, defMID));
+        assert (ExitStatus::NotSupported == retCode);
+
+        /* queue of values is not a queue of message pointers */
+        static_assert (!std::is_convertible<value_message_queue<> *, message_queue *>::value,
+                       "value_message_queue should not be usable as message_queue");
+
+        for (size_t ix = 0; ix < 10; ++ix)
+        {
+            retCode = (ix % 2)
+                ? queue.enqueue_value (defMID + ix)
+                : queue.enqueue_value<size_t> (defMID + ix, ix);
+            assert (ExitStatus::Success == retCode);
+        }
+
+        value_message_queue<> * queues[] = { &queue };
+        auto mqlist = poll (std::begin (queues), std::end (queues));
+        assert (1 == mqlist.size ());
+        assert (defQID == mqlist.front ().get_qid ());
+        assert (message_queue::notification_flag::data == mqlist.front ().get_flags ());
+
+        for (size_t ix = 0; ix < 5; ++ix)
+        {
+            assert (queue.pop_value (msg));
+            assert (defQID == msg.get_qid ());
+            assert ((defMID + ix) == msg.get_mid ());
+            assert ((ix % 2) ? !msg.has_payload () : (ix == *msg.get<size_t> ()));
+        }
+
+        value_message_queue<>::value_container_type batch;
+        assert (3 == queue.drain_values (batch, 3));
+        assert (2 == queue.drain_values (batch));
+        assert (5 == batch.size ());
+        for (size_t ix = 0; ix < 5; ++ix)
+        {
+            assert ((defMID + 5 + ix) == batch[ix].get_mid ());
+        }
+
+        assert (!queue.pop_value (msg));
+        mqlist = poll (std::begin (queues), std::end (queues));
+        assert (mqlist.empty ());
+    }
+    {
+        /*
+         * producer and consumer in different threads
+         */
+        using namespace mqmx;
+        const queue_id_type defQID = 10;
+        const size_t NMESSAGES = 10000;
+
+        value_message_queue<> queue (defQID);
+        std::thread producer ([&queue, defQID]
+                              {
+                                  for (size_t ix = 0; ix < NMESSAGES; ++ix)
+                                  {
+                                      const status_code retCode =
+                                          queue.enqueue_value<std::string> (ix, std::to_string (ix));
+                                      assert (ExitStatus::Success == retCode);
+                                  }
+                              });
+
+        value_message_queue<> * queues[] = { &queue };
+        size_t expected = 0;
+        while (expected < NMESSAGES)
+        {
+            poll (std::begin (queues), std::end (queues));
+
+            value_message msg;
+            while (queue.pop_value (msg))
+            {
+                assert (expected == msg.get_mid ());
+                assert (std::to_string (expected) == *msg.get<std::string> ());
+                ++expected;
+            }
+        }
+        producer.join ();
+    }
+    return 0;
+}
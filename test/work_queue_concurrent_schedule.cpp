@@ -0,0 +1,113 @@
+#include "mqmx/work_queue.h"
+#include <crs/semaphore.h>
+
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+#undef NDEBUG
+#include <cassert>
+
+int main ()
+{
+    using namespace mqmx;
+    using namespace std::chrono;
+
+    {
+        /*
+         * immediate works scheduled from many threads are all executed
+         * exactly once and get unique IDs
+         */
+        const size_t nthreads = 8;
+        const size_t nworks = 2000;
+
+        work_queue sut;
+        std::atomic<size_t> executed (0);
+        crs::semaphore all_executed;
+        std::vector<std::vector<work_queue::work_id_type>> ids (nthreads);
+
+        std::vector<std::thread> producers;
+        for (size_t t = 0; t < nthreads; ++t)
+        {
+            producers.emplace_back ([&, t]{
+                    const work_queue::client_id_type client_id = sut.get_client_id ();
+                    for (size_t i = 0; i < nworks; ++i)
+                    {
+                        status_code ec = ExitStatus::Success;
+                        work_queue::work_id_type work_id = work_queue::INVALID_WORK_ID;
+                        std::tie (ec, work_id) = sut.schedule_work (
+                            client_id,
+                            [&](const work_queue::work_id_type) {
+                                if (++executed == nthreads * nworks)
+                                    all_executed.post ();
+                                return false;
+                            });
+                        assert (ec == ExitStatus::Success);
+                        ids[t].push_back (work_id);
+                    }
+                });
+        }
+        for (auto & producer : producers)
+            producer.join ();
+
+        assert (all_executed.wait_for (seconds (10)));
+        assert (nthreads * nworks == executed);
+
+        std::set<work_queue::work_id_type> unique_ids;
+        for (const auto & thread_ids : ids)
+            unique_ids.insert (thread_ids.begin (), thread_ids.end ());
+        assert (nthreads * nworks == unique_ids.size ());
+        assert (0 == unique_ids.count (work_queue::INVALID_WORK_ID));
+
+        for (int i = 0; (i < 1000) && !sut.is_idle (); ++i)
+            std::this_thread::sleep_for (milliseconds (1));
+        assert (sut.is_idle ());
+    }
+    {
+        /*
+         * just scheduled work is visible to all other calls at once
+         */
+        work_queue sut;
+        const work_queue::client_id_type client_id = sut.get_client_id ();
+        const work_queue::time_point_type start = sut.get_current_time_point () + hours (1);
+        auto work = [](const work_queue::work_id_type) { return false; };
+
+        work_queue::work_id_type work_id = sut.schedule_work (client_id, work, start).second;
+        assert (!sut.is_idle ());
+        assert (start == sut.get_nearest_time_point ());
+        assert (ExitStatus::Success == sut.cancel_work (work_id));
+        assert (sut.is_idle ());
+
+        work_id = sut.schedule_work (client_id, work, start).second;
+        assert (ExitStatus::Success == sut.update_work (
+                    work_id, client_id, work, start + hours (1), work_queue::RUN_ONCE));
+        assert (start + hours (1) == sut.get_nearest_time_point ());
+        assert (ExitStatus::Success == sut.get_skipped_count (work_id).first);
+
+        sut.schedule_work (client_id, work, start);
+        assert (ExitStatus::Success == sut.cancel_client_works (client_id));
+        assert (sut.is_idle ());
+    }
+    {
+        /*
+         * work scheduled from another thread wakes up the worker waiting
+         * for a far time point
+         */
+        work_queue sut;
+        crs::semaphore done;
+        const work_queue::client_id_type client_id = sut.get_client_id ();
+        sut.schedule_work (client_id, [](const work_queue::work_id_type) { return false; },
+                           sut.get_current_time_point () + hours (1));
+
+        std::thread producer ([&]{
+                sut.schedule_work (client_id, [&](const work_queue::work_id_type) {
+                        done.post ();
+                        return false;
+                    });
+            });
+        producer.join ();
+        assert (done.wait_for (seconds (1)));
+    }
+    return 0;
+}
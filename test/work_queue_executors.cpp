@@ -0,0 +1,175 @@
+#include "mqmx/work_queue.h"
+#include <crs/semaphore.h>
+
+#include <atomic>
+#include <vector>
+
+#undef NDEBUG
+#include <cassert>
+
+int main ()
+{
+    using namespace mqmx;
+    using namespace std::chrono;
+
+    {
+        /*
+         * slow work doesn't delay other works
+         */
+        work_queue sut (4, false);
+        assert (4 == sut.get_executors_count ());
+
+        crs::semaphore slow_started;
+        crs::semaphore slow_release;
+        crs::semaphore fast_done;
+        std::atomic<bool> slow_completed (false);
+
+        const work_queue::client_id_type client_id = sut.get_client_id ();
+        assert (ExitStatus::Success == sut.schedule_work (
+                    client_id,
+                    [&](const work_queue::work_id_type) {
+                        slow_started.post ();
+                        slow_release.wait ();
+                        slow_completed = true;
+                        return false;
+                    }).first);
+        assert (slow_started.wait_for (seconds (1)));
+
+        const work_queue::time_point_type now = sut.get_current_time_point ();
+        for (int i = 0; i < 10; ++i)
+        {
+            assert (ExitStatus::Success == sut.schedule_work (
+                        client_id,
+                        [&](const work_queue::work_id_type) {
+                            fast_done.post ();
+                            return false;
+                        },
+                        now + milliseconds (i)).first);
+        }
+        for (int i = 0; i < 10; ++i)
+            assert (fast_done.wait_for (seconds (1)));
+        assert (!slow_completed);
+        assert (!sut.is_idle ());
+
+        slow_release.post ();
+        for (int i = 0; (i < 1000) && !sut.is_idle (); ++i)
+            std::this_thread::sleep_for (milliseconds (1));
+        assert (slow_completed);
+        assert (sut.is_idle ());
+    }
+    {
+        /*
+         * works of the same client are never executed concurrently, while
+         * works of different clients are
+         */
+        const int nclients = 4;
+        const int nworks = 50;
+
+        work_queue sut (4, true);
+
+        std::atomic<int> active[nclients];
+        std::atomic<int> total_active (0);
+        std::atomic<int> max_total_active (0);
+        std::atomic<bool> overlap (false);
+        std::vector<std::vector<work_queue::work_id_type>> order (nclients);
+        crs::semaphore done;
+
+        const work_queue::time_point_type start = sut.get_current_time_point () + milliseconds (20);
+        std::vector<work_queue::client_id_type> clients;
+        for (int c = 0; c < nclients; ++c)
+        {
+            active[c] = 0;
+            clients.push_back (sut.get_client_id ());
+        }
+
+        std::vector<std::vector<work_queue::work_id_type>> expected (nclients);
+        for (int i = 0; i < nworks; ++i)
+        {
+            for (int c = 0; c < nclients; ++c)
+            {
+                auto result = sut.schedule_work (
+                    clients[c],
+                    [&, c](const work_queue::work_id_type work_id) {
+                        if (active[c]++)
+                            overlap = true;
+                        int now_active = ++total_active;
+                        int prev_max = max_total_active;
+                        while ((prev_max < now_active) &&
+                               !max_total_active.compare_exchange_weak (prev_max, now_active))
+                            ;
+                        std::this_thread::sleep_for (microseconds (200));
+                        order[c].push_back (work_id);
+                        --total_active;
+                        --active[c];
+                        done.post ();
+                        return false;
+                    },
+                    start + microseconds (i));
+                assert (ExitStatus::Success == result.first);
+                expected[c].push_back (result.second);
+            }
+        }
+
+        for (int i = 0; i < nclients * nworks; ++i)
+            assert (done.wait_for (seconds (5)));
+        assert (!overlap);
+        assert (1 < max_total_active);
+        assert (expected == order);
+    }
+    {
+        /*
+         * running periodic work is cancelled or updated
+         */
+        work_queue sut (2, true);
+
+        crs::semaphore started;
+        crs::semaphore release;
+        std::atomic<int> executions (0);
+        std::atomic<int> updated_executions (0);
+
+        const work_queue::client_id_type client_id = sut.get_client_id ();
+        auto blocking_work = [&](const work_queue::work_id_type) {
+            ++executions;
+            started.post ();
+            release.wait ();
+            return true;
+        };
+
+        work_queue::work_id_type work_id = sut.schedule_work (
+            client_id, blocking_work, work_queue::time_point_type (), milliseconds (1)).second;
+        assert (started.wait_for (seconds (1)));
+        assert (ExitStatus::Success == sut.cancel_work (work_id));
+        assert (ExitStatus::NotFound == sut.cancel_work (work_id));
+        release.post ();
+
+        std::this_thread::sleep_for (milliseconds (20));
+        assert (1 == executions);
+        assert (sut.is_idle ());
+
+        work_id = sut.schedule_work (
+            client_id, blocking_work, work_queue::time_point_type (), milliseconds (1)).second;
+        assert (started.wait_for (seconds (1)));
+        assert (ExitStatus::Success == sut.update_work (
+                    work_id, client_id,
+                    [&](const work_queue::work_id_type) {
+                        ++updated_executions;
+                        return false;
+                    },
+                    sut.get_current_time_point (), work_queue::RUN_ONCE));
+        release.post ();
+
+        for (int i = 0; (i < 1000) && !sut.is_idle (); ++i)
+            std::this_thread::sleep_for (milliseconds (1));
+        assert (sut.is_idle ());
+        assert (2 == executions);
+        assert (1 == updated_executions);
+
+        work_id = sut.schedule_work (
+            client_id, blocking_work, work_queue::time_point_type (), milliseconds (1)).second;
+        assert (started.wait_for (seconds (1)));
+        assert (ExitStatus::Success == sut.cancel_client_works (client_id));
+        assert (ExitStatus::NotFound == sut.cancel_client_works (client_id));
+        release.post ();
+    }
+    return 0;
+}
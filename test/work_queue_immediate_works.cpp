@@ -0,0 +1,202 @@
+#include "mqmx/work_queue.h"
+#include <crs/semaphore.h>
+
+#include <atomic>
+#include <vector>
+
+#undef NDEBUG
+#include <cassert>
+
+namespace
+{
+    using mqmx::work_queue;
+
+    /* schedules a work, which blocks the worker until released */
+    void block_worker (work_queue & sut, const work_queue::client_id_type client_id,
+                       crs::semaphore & started, crs::semaphore & release)
+    {
+        assert (mqmx::ExitStatus::Success == sut.schedule_work (
+                    client_id,
+                    [&started, &release](const work_queue::work_id_type) {
+                        started.post ();
+                        release.wait ();
+                        return false;
+                    }).first);
+        assert (started.wait_for (std::chrono::seconds (1)));
+    }
+
+    void wait_for_idle (const work_queue & sut)
+    {
+        for (int i = 0; (i < 1000) && !sut.is_idle (); ++i)
+            std::this_thread::sleep_for (std::chrono::milliseconds (1));
+        assert (sut.is_idle ());
+    }
+}
+
+int main ()
+{
+    using namespace mqmx;
+    using namespace std::chrono;
+
+    {
+        /*
+         * immediate works are executed in order of scheduling, timers due
+         * are executed after every burst of immediate works
+         */
+        work_queue sut;
+        assert (work_queue::DEFAULT_IMMEDIATE_BURST == sut.get_immediate_burst ());
+        sut.set_immediate_burst (2);
+        assert (2 == sut.get_immediate_burst ());
+
+        crs::semaphore started;
+        crs::semaphore release;
+        std::vector<int> order;
+        const work_queue::client_id_type client_id = sut.get_client_id ();
+        block_worker (sut, client_id, started, release);
+
+        /* timer is already due, when the worker is released */
+        assert (ExitStatus::Success == sut.schedule_work (
+                    client_id,
+                    [&order](const work_queue::work_id_type) {
+                        order.push_back (0);
+                        return false;
+                    },
+                    sut.get_current_time_point ()).first);
+        for (int i = 1; i <= 6; ++i)
+        {
+            assert (ExitStatus::Success == sut.schedule_work (
+                        client_id,
+                        [&order, i](const work_queue::work_id_type) {
+                            order.push_back (i);
+                            return false;
+                        }).first);
+        }
+        assert (!sut.is_idle ());
+
+        release.post ();
+        wait_for_idle (sut);
+        assert ((std::vector<int> {1, 0, 2, 3, 4, 5, 6}) == order);
+    }
+    {
+        /*
+         * immediate works scheduled one by one and in batches are executed
+         * in order of scheduling
+         */
+        work_queue sut;
+        crs::semaphore started;
+        crs::semaphore release;
+        std::vector<int> order;
+        const work_queue::client_id_type client_id = sut.get_client_id ();
+        block_worker (sut, client_id, started, release);
+
+        auto make_work = [&order](const int i) {
+            return [&order, i](const work_queue::work_id_type) {
+                order.push_back (i);
+                return false;
+            };
+        };
+        assert (ExitStatus::Success == sut.schedule_work (client_id, make_work (1)).first);
+        assert (ExitStatus::Success == sut.schedule_work (client_id, make_work (2)).first);
+        assert (ExitStatus::Success == sut.schedule_works (
+                    client_id, {work_queue::work_entry (make_work (3)),
+                                work_queue::work_entry (make_work (4))}).first);
+        assert (ExitStatus::Success == sut.schedule_work (client_id, make_work (5)).first);
+        assert (ExitStatus::Success == sut.schedule_works (
+                    client_id, {work_queue::work_entry (make_work (6))}).first);
+
+        release.post ();
+        wait_for_idle (sut);
+        assert ((std::vector<int> {1, 2, 3, 4, 5, 6}) == order);
+    }
+    {
+        /*
+         * immediate works are executed with zero burst, while timer is
+         * pending in the future
+         */
+        work_queue sut;
+        sut.set_immediate_burst (0);
+
+        const work_queue::client_id_type client_id = sut.get_client_id ();
+        assert (ExitStatus::Success == sut.schedule_work (
+                    client_id,
+                    [](const work_queue::work_id_type) { return false; },
+                    sut.get_current_time_point () + seconds (10)).first);
+
+        crs::semaphore done;
+        for (int i = 0; i < 2; ++i)
+        {
+            assert (ExitStatus::Success == sut.schedule_work (
+                        client_id,
+                        [&done](const work_queue::work_id_type) {
+                            done.post ();
+                            return false;
+                        }).first);
+        }
+        assert (done.wait_for (seconds (1)));
+        assert (done.wait_for (seconds (1)));
+    }
+    {
+        /*
+         * immediate works waiting for execution are cancelled and updated
+         */
+        work_queue sut;
+        crs::semaphore started;
+        crs::semaphore release;
+        std::atomic<int> executed (0);
+        auto work = [&executed](const work_queue::work_id_type) {
+            ++executed;
+            return false;
+        };
+
+        const work_queue::client_id_type client_id = sut.get_client_id ();
+        const work_queue::client_id_type other_client_id = sut.get_client_id ();
+        block_worker (sut, client_id, started, release);
+
+        const work_queue::work_id_type cancelled_id = sut.schedule_work (client_id, work).second;
+        const work_queue::work_id_type updated_id = sut.schedule_work (client_id, work).second;
+        const work_queue::work_id_type kept_id = sut.schedule_work (client_id, work).second;
+        sut.schedule_work (other_client_id, work);
+        sut.schedule_works (other_client_id, {work_queue::work_entry (work),
+                                              work_queue::work_entry (work)});
+
+        assert (ExitStatus::Success == sut.cancel_work (cancelled_id));
+        assert (ExitStatus::NotFound == sut.cancel_work (cancelled_id));
+        assert (ExitStatus::Success == sut.get_skipped_count (kept_id).first);
+        assert (0 == sut.get_skipped_count (kept_id).second);
+
+        const work_queue::time_point_type start = sut.get_current_time_point () + hours (1);
+        assert (ExitStatus::Success == sut.update_work (
+                    updated_id, client_id, work, start, work_queue::RUN_ONCE));
+        assert (start == sut.get_nearest_time_point ());
+        assert (ExitStatus::Success == sut.cancel_client_works (other_client_id));
+
+        release.post ();
+        for (int i = 0; (i < 1000) && (executed < 1); ++i)
+            std::this_thread::sleep_for (milliseconds (1));
+        std::this_thread::sleep_for (milliseconds (10));
+        assert (1 == executed);
+
+        assert (ExitStatus::Success == sut.cancel_work (updated_id));
+        wait_for_idle (sut);
+    }
+    {
+        /*
+         * immediate works are dispatched to executors
+         */
+        work_queue sut (4, true);
+        std::atomic<int> executed (0);
+        crs::semaphore done;
+        const work_queue::client_id_type client_id = sut.get_client_id ();
+        for (int i = 0; i < 100; ++i)
+        {
+            sut.schedule_work (client_id, [&](const work_queue::work_id_type) {
+                    if (++executed == 100)
+                        done.post ();
+                    return false;
+                });
+        }
+        assert (done.wait_for (seconds (1)));
+        wait_for_idle (sut);
+    }
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include "mqmx/testing/work_queue_for_tests.h"
+
+#include <vector>
+
+#undef NDEBUG
+#include <cassert>
+
+namespace
+{
+    unsigned long skipped_count (const mqmx::work_queue & wq,
+                                 const mqmx::work_queue::work_id_type work_id)
+    {
+        const auto result = wq.get_skipped_count (work_id);
+        assert (mqmx::ExitStatus::Success == result.first);
+        return result.second;
+    }
+}
+
+int main ()
+{
+    using namespace mqmx;
+    using namespace std::chrono;
+
+    auto work = [](const work_queue::work_id_type) { return true; };
+
+    {
+        /*
+         * fixed rate - missed executions are performed back-to-back
+         */
+        std::vector<work_queue::time_point_type> executed;
+        testing::work_queue_for_tests sut (
+            [&executed](const work_queue::work_id_type,
+                        const work_queue::time_point_type tp) {
+                executed.push_back (tp);
+            });
+
+        const work_queue::client_id_type client_id = sut.get_client_id ();
+        const work_queue::time_point_type now = sut.get_current_time_point ();
+        const work_queue::work_id_type work_id = sut.schedule_work (
+            client_id, work, now + milliseconds (100), milliseconds (100)).second;
+
+        assert (sut.forward_time (milliseconds (350)));
+        assert (3 == executed.size ());
+        assert (now + milliseconds (300) == executed.back ());
+        assert (now + milliseconds (400) == sut.get_nearest_time_point ());
+        assert (0 == skipped_count (sut, work_id));
+    }
+    {
+        /*
+         * fixed rate with skipping - missed executions are skipped and counted
+         */
+        std::vector<work_queue::time_point_type> executed;
+        testing::work_queue_for_tests sut (
+            [&executed](const work_queue::work_id_type,
+                        const work_queue::time_point_type tp) {
+                executed.push_back (tp);
+            });
+
+        const work_queue::client_id_type client_id = sut.get_client_id ();
+        const work_queue::time_point_type now = sut.get_current_time_point ();
+        const work_queue::work_id_type work_id = sut.schedule_work (
+            client_id, work, now + milliseconds (100), milliseconds (100),
+            work_queue::fixed_rate_skip).second;
+
+        assert (sut.forward_time (milliseconds (350)));
+        assert (1 == executed.size ());
+        assert (now + milliseconds (400) == sut.get_nearest_time_point ());
+        assert (2 == skipped_count (sut, work_id));
+
+        /* in time - nothing is skipped */
+        assert (sut.forward_time (milliseconds (50)));
+        assert (2 == executed.size ());
+        assert (now + milliseconds (500) == sut.get_nearest_time_point ());
+        assert (2 == skipped_count (sut, work_id));
+
+        /* exactly on the grid - execution is not missed */
+        assert (sut.forward_time (milliseconds (200)));
+        assert (4 == executed.size ());
+        assert (now + milliseconds (600) == executed.back ());
+        assert (now + milliseconds (700) == sut.get_nearest_time_point ());
+        assert (2 == skipped_count (sut, work_id));
+
+        assert (ExitStatus::Success == sut.update_work (
+                    work_id, client_id, work, now + milliseconds (1000),
+                    milliseconds (100), work_queue::fixed_rate_skip));
+        assert (0 == skipped_count (sut, work_id));
+
+        assert (ExitStatus::Success == sut.cancel_work (work_id));
+        assert (ExitStatus::NotFound == sut.get_skipped_count (work_id).first);
+    }
+    {
+        /*
+         * fixed delay - next execution is scheduled since completion
+         */
+        std::vector<work_queue::time_point_type> executed;
+        testing::work_queue_for_tests sut (
+            [&executed](const work_queue::work_id_type,
+                        const work_queue::time_point_type tp) {
+                executed.push_back (tp);
+            });
+
+        const work_queue::client_id_type client_id = sut.get_client_id ();
+        const work_queue::time_point_type now = sut.get_current_time_point ();
+        work_queue::work_entries_type works = {
+            {work, now + milliseconds (100), milliseconds (100), work_queue::fixed_delay}
+        };
+        const work_queue::work_id_type work_id =
+            sut.schedule_works (client_id, works).second.front ();
+
+        assert (sut.forward_time (milliseconds (350)));
+        assert (1 == executed.size ());
+        assert (now + milliseconds (450) == sut.get_nearest_time_point ());
+        assert (0 == skipped_count (sut, work_id));
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include "mqmx/testing/work_queue_for_tests.h"
+
+#include <algorithm>
+#include <vector>
+
+#undef NDEBUG
+#include <cassert>
+
+namespace
+{
+    typedef std::pair<mqmx::work_queue::work_id_type,
+                      mqmx::work_queue::time_point_type> execution_type;
+
+    void run (const mqmx::work_queue::timer_engine engine)
+    {
+        using namespace mqmx;
+        using namespace std::chrono;
+
+        std::vector<execution_type> executed;
+        testing::work_queue_for_tests sut (
+            [&executed](const work_queue::work_id_type work_id,
+                        const work_queue::time_point_type tp) {
+                executed.emplace_back (work_id, tp);
+            },
+            engine);
+
+        const work_queue::client_id_type client_id = sut.get_client_id ();
+        const work_queue::time_point_type now = sut.get_current_time_point ();
+        auto work = [](const work_queue::work_id_type) { return false; };
+
+        /* invalid entry - nothing is scheduled */
+        work_queue::work_entries_type works = {
+            {work, now + milliseconds (1), work_queue::RUN_ONCE},
+            {work_queue::work_pointer_type (), now, work_queue::RUN_ONCE},
+        };
+        auto result = sut.schedule_works (client_id, works);
+        assert (ExitStatus::InvalidArgument == result.first);
+        assert (result.second.empty ());
+        assert (sut.is_idle ());
+
+        result = sut.schedule_works (work_queue::INVALID_CLIENT_ID, {});
+        assert (ExitStatus::InvalidArgument == result.first);
+
+        /* big batch, then small batches into the bigger queue */
+        std::vector<execution_type> expected;
+        for (size_t nworks : {200, 20, 1})
+        {
+            works.clear ();
+            for (size_t i = 0; i < nworks; ++i)
+            {
+                const auto offset = milliseconds (10 + (i * 7919) % 1000);
+                works.push_back ({work, now + offset, work_queue::RUN_ONCE});
+            }
+
+            result = sut.schedule_works (client_id, works);
+            assert (ExitStatus::Success == result.first);
+            assert (nworks == result.second.size ());
+            for (size_t i = 0; i < nworks; ++i)
+            {
+                assert (work_queue::INVALID_WORK_ID != result.second[i]);
+                expected.emplace_back (result.second[i], works[i].start_time);
+            }
+        }
+        std::stable_sort (expected.begin (), expected.end (),
+                          [](const execution_type & a, const execution_type & b) {
+                              return a.second < b.second;
+                          });
+
+        /* works of the batch are regular works */
+        assert (ExitStatus::Success == sut.cancel_work (expected.back ().first));
+        expected.pop_back ();
+
+        assert (sut.forward_time (seconds (2)));
+        assert (expected.size () == executed.size ());
+        for (size_t i = 0; i < executed.size (); ++i)
+            assert (expected[i].second == executed[i].second);
+        assert (sut.is_idle ());
+
+        /* empty start time means now, periodic works are rescheduled */
+        executed.clear ();
+        result = sut.schedule_works (
+            client_id, {{[](const work_queue::work_id_type) { return true; },
+                         work_queue::time_point_type (), milliseconds (100)}});
+        assert (ExitStatus::Success == result.first);
+        assert (sut.forward_time (milliseconds (250)));
+        assert (3 == executed.size ());
+        assert (ExitStatus::Success == sut.cancel_client_works (client_id));
+    }
+}
+
+int main ()
+{
+    run (mqmx::work_queue::binary_heap);
+    run (mqmx::work_queue::timer_wheel);
+    return 0;
+}
@@ -0,0 +1,122 @@
+#include "mqmx/testing/work_queue_for_tests.h"
+
+#include <atomic>
+#include <vector>
+
+#undef NDEBUG
+#include <cassert>
+
+namespace
+{
+    /* works within the slack window might be executed after the time
+     * forwarding is completed, so their execution is awaited separately */
+    bool wait_for_count (const std::atomic<size_t> & counter, const size_t count)
+    {
+        for (int i = 0; (i < 1000) && (counter < count); ++i)
+            std::this_thread::sleep_for (std::chrono::milliseconds (1));
+        return (counter == count);
+    }
+}
+
+int main ()
+{
+    using namespace mqmx;
+    using namespace std::chrono;
+
+    {
+        /*
+         * works within the slack window are executed together
+         */
+        std::vector<work_queue::work_id_type> executed;
+        std::atomic<size_t> count (0);
+        testing::work_queue_for_tests sut (
+            [&](const work_queue::work_id_type work_id,
+                const work_queue::time_point_type) {
+                executed.push_back (work_id);
+                ++count;
+            });
+
+        assert (0 == sut.get_slack ().count ());
+        sut.set_slack (milliseconds (10));
+        assert (milliseconds (10) == sut.get_slack ());
+
+        const work_queue::client_id_type client_id = sut.get_client_id ();
+        const work_queue::time_point_type now = sut.get_current_time_point ();
+        auto work = [](const work_queue::work_id_type) { return false; };
+
+        std::vector<work_queue::work_id_type> ids;
+        for (int offset : {5, 8, 14, 30})
+            ids.push_back (sut.schedule_work (client_id, work, now + milliseconds (offset)).second);
+
+        assert (sut.forward_time (milliseconds (5)));
+        assert (wait_for_count (count, 3));
+        assert ((std::vector<work_queue::work_id_type> {ids[0], ids[1], ids[2]}) == executed);
+        assert (now + milliseconds (30) == sut.get_nearest_time_point ());
+
+        assert (sut.forward_time ());
+        assert (wait_for_count (count, 4));
+        assert (ids[3] == executed.back ());
+    }
+    {
+        /*
+         * periodic works are rescheduled relative to their own time points
+         */
+        std::vector<work_queue::time_point_type> executed;
+        std::atomic<size_t> count (0);
+        testing::work_queue_for_tests sut (
+            [&](const work_queue::work_id_type,
+                const work_queue::time_point_type tp) {
+                executed.push_back (tp);
+                ++count;
+            });
+        sut.set_slack (milliseconds (30));
+
+        const work_queue::client_id_type client_id = sut.get_client_id ();
+        const work_queue::time_point_type now = sut.get_current_time_point ();
+        sut.schedule_work (client_id, [](const work_queue::work_id_type) { return true; },
+                           now + milliseconds (100), milliseconds (100));
+
+        assert (sut.forward_time (milliseconds (100)));
+        assert (wait_for_count (count, 1));
+        assert (sut.forward_time (milliseconds (80)));
+        assert (wait_for_count (count, 2));
+        assert (now + milliseconds (100) == executed[0]);
+        assert (now + milliseconds (200) == executed[1]);
+        assert (now + milliseconds (300) == sut.get_nearest_time_point ());
+        assert (ExitStatus::Success == sut.cancel_client_works (client_id));
+    }
+    {
+        /*
+         * real time queue wakes up once for the whole window
+         */
+        work_queue sut;
+        sut.set_slack (milliseconds (200));
+
+        crs::mutex_type mutex;
+        std::vector<work_queue::time_point_type> executed;
+        const work_queue::client_id_type client_id = sut.get_client_id ();
+        const work_queue::time_point_type start =
+            sut.get_current_time_point () + milliseconds (50);
+
+        work_queue::work_entries_type works;
+        for (int i = 0; i < 10; ++i)
+        {
+            works.push_back ({[&](const work_queue::work_id_type) {
+                        crs::lock_type guard (mutex);
+                        executed.push_back (work_queue::clock_type::now ());
+                        return false;
+                    }, start + milliseconds (10 * i), work_queue::RUN_ONCE});
+        }
+        assert (ExitStatus::Success == sut.schedule_works (client_id, works).first);
+
+        for (int i = 0; (i < 1000) && !sut.is_idle (); ++i)
+            std::this_thread::sleep_for (milliseconds (1));
+        assert (sut.is_idle ());
+
+        crs::lock_type guard (mutex);
+        assert (10 == executed.size ());
+        assert (start <= executed.front ());
+        assert (executed.back () - executed.front () < milliseconds (50));
+    }
+    return 0;
+}
@@ -0,0 +1,173 @@
+#include "mqmx/testing/work_queue_for_tests.h"
+#include <crs/semaphore.h>
+
+#include <vector>
+#include <algorithm>
+
+#undef NDEBUG
+#include <cassert>
+
+namespace
+{
+    typedef std::pair<mqmx::work_queue::work_id_type,
+                      mqmx::work_queue::time_point_type> execution_type;
+}
+
+int main ()
+{
+    using namespace mqmx;
+    using namespace std::chrono;
+
+    {
+        /*
+         * works from every level of the wheel (and beyond) are executed in
+         * order of their time points, cancelled ones are not executed
+         */
+        std::vector<execution_type> executed;
+        testing::work_queue_for_tests sut (
+            [&executed](const work_queue::work_id_type work_id,
+                        const work_queue::time_point_type tp) {
+                executed.emplace_back (work_id, tp);
+            },
+            work_queue::timer_wheel);
+
+        const work_queue::client_id_type client_id = sut.get_client_id ();
+        const work_queue::time_point_type now = sut.get_current_time_point ();
+        const std::vector<work_queue::duration_type> offsets = {
+            hours (24 * 60), microseconds (10), milliseconds (300), seconds (70),
+            microseconds (300), hours (5), microseconds (20), milliseconds (3),
+            hours (24 * 60) + microseconds (1), milliseconds (255), minutes (20),
+            milliseconds (256), microseconds (5), milliseconds (65536)
+        };
+
+        std::vector<execution_type> expected;
+        std::vector<work_queue::work_id_type> cancelled;
+        for (size_t i = 0; i < offsets.size (); ++i)
+        {
+            status_code ec = ExitStatus::Success;
+            work_queue::work_id_type work_id = work_queue::INVALID_WORK_ID;
+            std::tie (ec, work_id) = sut.schedule_work (
+                client_id, [](const work_queue::work_id_type) { return false; },
+                now + offsets[i]);
+            assert (ec == ExitStatus::Success);
+
+            if (i % 5 == 4)
+                cancelled.push_back (work_id);
+            else
+                expected.emplace_back (work_id, now + offsets[i]);
+        }
+        std::stable_sort (expected.begin (), expected.end (),
+                          [](const execution_type & a, const execution_type & b) {
+                              return a.second < b.second;
+                          });
+
+        for (const auto work_id : cancelled)
+            assert (ExitStatus::Success == sut.cancel_work (work_id));
+        assert (ExitStatus::NotFound == sut.cancel_work (cancelled.front ()));
+        assert (now + microseconds (5) == sut.get_nearest_time_point ());
+
+        /* step by step the wheel advances to the nearest work only */
+        assert (sut.forward_time ());
+        assert (1 == executed.size ());
+        assert (sut.forward_time (milliseconds (1)));
+        assert (3 == executed.size ());
+
+        assert (sut.forward_time (hours (24 * 61)));
+        assert (expected == executed);
+        assert (sut.is_idle ());
+    }
+    {
+        /*
+         * updated works are moved within the wheel, periodic works are
+         * rescheduled, client works are removed
+         */
+        std::vector<execution_type> executed;
+        testing::work_queue_for_tests sut (
+            [&executed](const work_queue::work_id_type work_id,
+                        const work_queue::time_point_type tp) {
+                executed.emplace_back (work_id, tp);
+            },
+            work_queue::timer_wheel, milliseconds (10));
+
+        const work_queue::client_id_type client_id = sut.get_client_id ();
+        const work_queue::client_id_type other_client_id = sut.get_client_id ();
+        const work_queue::time_point_type now = sut.get_current_time_point ();
+        auto work = [](const work_queue::work_id_type) { return true; };
+
+        work_queue::work_id_type periodic_id = work_queue::INVALID_WORK_ID;
+        work_queue::work_id_type updated_id = work_queue::INVALID_WORK_ID;
+        work_queue::work_id_type other_id = work_queue::INVALID_WORK_ID;
+        status_code ec = ExitStatus::Success;
+
+        std::tie (ec, periodic_id) = sut.schedule_work (
+            client_id, work, now + milliseconds (100), milliseconds (100));
+        assert (ec == ExitStatus::Success);
+        std::tie (ec, updated_id) = sut.schedule_work (
+            client_id, work, now + hours (1));
+        assert (ec == ExitStatus::Success);
+        std::tie (ec, other_id) = sut.schedule_work (
+            other_client_id, work, now + milliseconds (150), milliseconds (100));
+        assert (ec == ExitStatus::Success);
+
+        assert (ExitStatus::Success == sut.update_work (
+                    updated_id, client_id, work, now + milliseconds (250),
+                    work_queue::RUN_ONCE));
+        assert (ExitStatus::NotFound == sut.update_work (
+                    work_queue::INVALID_WORK_ID - 1, client_id, work,
+                    now, work_queue::RUN_ONCE));
+
+        assert (sut.forward_time (milliseconds (260)));
+        const std::vector<execution_type> expected = {
+            {periodic_id, now + milliseconds (100)},
+            {other_id, now + milliseconds (150)},
+            {periodic_id, now + milliseconds (200)},
+            {updated_id, now + milliseconds (250)},
+            {other_id, now + milliseconds (250)},
+        };
+        assert (expected == executed);
+
+        assert (ExitStatus::Success == sut.cancel_client_works (other_client_id));
+        assert (ExitStatus::NotFound == sut.cancel_client_works (other_client_id));
+        assert (now + milliseconds (300) == sut.get_nearest_time_point ());
+
+        executed.clear ();
+        assert (sut.forward_time (milliseconds (1000)));
+        assert (10 == executed.size ());
+        for (const auto & e : executed)
+            assert (periodic_id == e.first);
+        assert (now + milliseconds (1200) == executed.back ().second);
+
+        assert (ExitStatus::Success == sut.cancel_work (periodic_id));
+        assert (sut.is_idle ());
+    }
+    {
+        /*
+         * real time queue with the wheel engine
+         */
+        crs::semaphore sem;
+        std::vector<int> order;
+        work_queue sut (work_queue::timer_wheel);
+
+        const work_queue::client_id_type client_id = sut.get_client_id ();
+        const work_queue::time_point_type now = sut.get_current_time_point ();
+        for (int i : {3, 1, 2})
+        {
+            status_code ec = ExitStatus::Success;
+            work_queue::work_id_type work_id = work_queue::INVALID_WORK_ID;
+            std::tie (ec, work_id) = sut.schedule_work (
+                client_id,
+                [&order, &sem, i](const work_queue::work_id_type) {
+                    order.push_back (i);
+                    sem.post ();
+                    return false;
+                },
+                now + milliseconds (10 * i));
+            assert (ec == ExitStatus::Success);
+        }
+
+        for (int i = 0; i < 3; ++i)
+            assert (sem.wait_for (seconds (1)));
+        assert ((std::vector<int> {1, 2, 3}) == order);
+    }
+    return 0;
+}
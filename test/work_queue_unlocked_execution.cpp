@@ -0,0 +1,133 @@
+#include "mqmx/work_queue.h"
+#include <crs/semaphore.h>
+
+#include <atomic>
+
+#undef NDEBUG
+#include <cassert>
+
+int main ()
+{
+    using namespace mqmx;
+    using namespace std::chrono;
+
+    {
+        /*
+         * queue is accessible while work is being executed
+         */
+        work_queue sut;
+
+        crs::semaphore started;
+        crs::semaphore release;
+        crs::semaphore other_done;
+
+        const work_queue::client_id_type client_id = sut.get_client_id ();
+        assert (ExitStatus::Success == sut.schedule_work (
+                    client_id,
+                    [&](const work_queue::work_id_type) {
+                        started.post ();
+                        assert (release.wait_for (seconds (5)));
+                        return false;
+                    }).first);
+        assert (started.wait_for (seconds (1)));
+
+        /* none of the calls below blocks behind the running work */
+        work_queue::work_id_type work_id = work_queue::INVALID_WORK_ID;
+        status_code ec = ExitStatus::Success;
+        std::tie (ec, work_id) = sut.schedule_work (
+            client_id,
+            [&](const work_queue::work_id_type) {
+                other_done.post ();
+                return false;
+            },
+            sut.get_current_time_point () + hours (1));
+        assert (ec == ExitStatus::Success);
+        assert (!sut.is_idle ());
+        assert (!is_time_point_empty (sut.get_nearest_time_point ()));
+        assert (ExitStatus::Success == sut.update_work (
+                    work_id, client_id,
+                    [&](const work_queue::work_id_type) {
+                        other_done.post ();
+                        return false;
+                    },
+                    sut.get_current_time_point (), work_queue::RUN_ONCE));
+        release.post ();
+
+        assert (other_done.wait_for (seconds (1)));
+    }
+    {
+        /*
+         * running work cancels and updates itself
+         */
+        work_queue sut;
+
+        crs::semaphore done;
+        std::atomic<int> executions (0);
+        const work_queue::client_id_type client_id = sut.get_client_id ();
+
+        assert (ExitStatus::Success == sut.schedule_work (
+                    client_id,
+                    [&](const work_queue::work_id_type work_id) {
+                        ++executions;
+                        assert (ExitStatus::Success == sut.cancel_work (work_id));
+                        assert (ExitStatus::NotFound == sut.cancel_work (work_id));
+                        done.post ();
+                        return true;
+                    },
+                    work_queue::time_point_type (), milliseconds (1)).first);
+        assert (done.wait_for (seconds (1)));
+
+        std::atomic<int> updated_executions (0);
+        assert (ExitStatus::Success == sut.schedule_work (
+                    client_id,
+                    [&](const work_queue::work_id_type work_id) {
+                        assert (ExitStatus::Success == sut.update_work (
+                                    work_id, client_id,
+                                    [&](const work_queue::work_id_type) {
+                                        ++updated_executions;
+                                        done.post ();
+                                        return false;
+                                    },
+                                    sut.get_current_time_point () + milliseconds (5),
+                                    work_queue::RUN_ONCE));
+                        return true;
+                    },
+                    work_queue::time_point_type (), milliseconds (1)).first);
+        assert (done.wait_for (seconds (1)));
+
+        std::this_thread::sleep_for (milliseconds (20));
+        assert (1 == executions);
+        assert (1 == updated_executions);
+        assert (sut.is_idle ());
+    }
+    {
+        /*
+         * periodic work cancelled while running is not rescheduled
+         */
+        work_queue sut;
+
+        crs::semaphore started;
+        crs::semaphore release;
+        std::atomic<int> executions (0);
+        const work_queue::client_id_type client_id = sut.get_client_id ();
+
+        work_queue::work_id_type work_id = sut.schedule_work (
+            client_id,
+            [&](const work_queue::work_id_type) {
+                ++executions;
+                started.post ();
+                release.wait ();
+                return true;
+            },
+            work_queue::time_point_type (), milliseconds (1)).second;
+        assert (started.wait_for (seconds (1)));
+        assert (ExitStatus::Success == sut.cancel_client_works (client_id));
+        release.post ();
+
+        std::this_thread::sleep_for (milliseconds (20));
+        assert (1 == executions);
+        assert (sut.is_idle ());
+        assert (ExitStatus::NotFound == sut.cancel_work (work_id));
+    }
+    return 0;
+}